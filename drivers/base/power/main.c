@@ -452,6 +452,52 @@ static void pm_dev_err(struct device *dev, pm_message_t state, const char *info,
 		error);
 }
 
+/*
+ * The slowest device callback of the current phase.  Callbacks of async
+ * devices run in parallel, so the phase duration is bounded below by this
+ * callback; it is reported and reset by dpm_show_time().
+ */
+static DEFINE_SPINLOCK(dpm_slowest_lock);
+static struct {
+	char		dev_name[48];
+	pm_callback_t	cb;
+	s64		usecs;
+} dpm_slowest;
+
+static void dpm_note_callback_time(struct device *dev, pm_callback_t cb,
+				   ktime_t starttime)
+{
+	s64 usecs = ktime_us_delta(ktime_get(), starttime);
+	unsigned long flags;
+
+	if (usecs <= READ_ONCE(dpm_slowest.usecs))
+		return;
+
+	spin_lock_irqsave(&dpm_slowest_lock, flags);
+	if (usecs > dpm_slowest.usecs) {
+		strscpy(dpm_slowest.dev_name, dev_name(dev),
+			sizeof(dpm_slowest.dev_name));
+		dpm_slowest.cb = cb;
+		WRITE_ONCE(dpm_slowest.usecs, usecs);
+	}
+	spin_unlock_irqrestore(&dpm_slowest_lock, flags);
+}
+
+static void dpm_show_slowest(pm_message_t state, const char *info)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&dpm_slowest_lock, flags);
+	if (dpm_slowest.cb)
+		pm_pr_dbg("%s%s%s slowest device %s: %pS took %lld usecs\n",
+			  info ?: "", info ? " " : "", pm_verb(state.event),
+			  dpm_slowest.dev_name, dpm_slowest.cb,
+			  dpm_slowest.usecs);
+	dpm_slowest.cb = NULL;
+	WRITE_ONCE(dpm_slowest.usecs, 0);
+	spin_unlock_irqrestore(&dpm_slowest_lock, flags);
+}
+
 static void dpm_show_time(ktime_t starttime, pm_message_t state, int error,
 			  const char *info)
 {
@@ -470,12 +516,13 @@ static void dpm_show_time(ktime_t starttime, pm_message_t state, int error,
 		  info ?: "", info ? " " : "", pm_verb(state.event),
 		  error ? "aborted" : "complete",
 		  usecs / USEC_PER_MSEC, usecs % USEC_PER_MSEC);
+	dpm_show_slowest(state, info);
 }
 
 static int dpm_run_callback(pm_callback_t cb, struct device *dev,
 			    pm_message_t state, const char *info)
 {
-	ktime_t calltime;
+	ktime_t calltime, starttime;
 	int error;
 
 	if (!cb)
@@ -485,7 +532,9 @@ static int dpm_run_callback(pm_callback_t cb, struct device *dev,
 
 	pm_dev_dbg(dev, state, info);
 	trace_device_pm_callback_start(dev, info, state.event);
+	starttime = ktime_get();
 	error = cb(dev);
+	dpm_note_callback_time(dev, cb, starttime);
 	trace_device_pm_callback_end(dev, error);
 	suspend_report_result(cb, error);
 
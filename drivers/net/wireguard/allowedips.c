@@ -6,8 +6,39 @@
 #include "allowedips.h"
 #include "peer.h"
 
+#include <linux/hash.h>
+
 static struct kmem_cache *node_cache;
 
+/* A small direct-mapped cache of recent lookup results, shared by all tables
+ * on a CPU. An entry is only trusted while its table's seq is unchanged, and
+ * seq values are drawn from a global counter, so a table reusing the memory
+ * of a freed one can never match a stale entry.
+ */
+#define LOOKUP_CACHE_BITS 6
+
+struct lookup_cache_entry {
+	const struct allowedips *table;
+	struct allowedips_node *node;
+	u64 seq;
+	u8 ip[16] __aligned(__alignof(u64));
+	u8 bits;
+};
+
+static DEFINE_PER_CPU(struct lookup_cache_entry[1 << LOOKUP_CACHE_BITS],
+		      lookup_cache);
+static atomic64_t table_seq = ATOMIC64_INIT(0);
+
+/* Called before and after every change to a table, so that a lookup racing
+ * with the change caches its result under a seq that is already stale.
+ */
+static void bump_seq(struct allowedips *table)
+{
+	smp_wmb();
+	WRITE_ONCE(table->seq, atomic64_inc_return(&table_seq));
+	smp_wmb();
+}
+
 static void swap_endian(u8 *dst, const u8 *src, u8 bits)
 {
 	if (bits == 32) {
@@ -120,6 +151,28 @@ static struct allowedips_node *find_node(struct allowedips_node *trie, u8 bits,
 	return found;
 }
 
+/* Returns a strong reference to a peer, and the node it was found at in
+ * *rnode. Must be called with rcu_read_lock_bh held and an ip that has
+ * already been passed through swap_endian.
+ */
+static struct wg_peer *find_peer(struct allowedips_node __rcu *root, u8 bits,
+				 const u8 *ip, struct allowedips_node **rnode)
+{
+	struct allowedips_node *node;
+	struct wg_peer *peer = NULL;
+
+retry:
+	node = find_node(rcu_dereference_bh(root), bits, ip);
+	if (node) {
+		peer = wg_peer_get_maybe_zero(rcu_dereference_bh(node->peer));
+		if (!peer)
+			goto retry;
+	}
+	*rnode = node;
+	return peer;
+}
+
+#ifdef DEBUG
 /* Returns a strong reference to a peer */
 static struct wg_peer *lookup(struct allowedips_node __rcu *root, u8 bits,
 			      const void *be_ip)
@@ -127,18 +180,62 @@ static struct wg_peer *lookup(struct allowedips_node __rcu *root, u8 bits,
 	/* Aligned so it can be passed to fls/fls64 */
 	u8 ip[16] __aligned(__alignof(u64));
 	struct allowedips_node *node;
+	struct wg_peer *peer;
+
+	swap_endian(ip, be_ip, bits);
+
+	rcu_read_lock_bh();
+	peer = find_peer(root, bits, ip, &node);
+	rcu_read_unlock_bh();
+	return peer;
+}
+#endif
+
+static struct lookup_cache_entry *cache_slot(const struct allowedips *table,
+					      const u8 *ip, u8 bits)
+{
+	u32 hash = *(const u32 *)&ip[bits / 8U - 4U];
+
+	if (bits == 128)
+		hash ^= *(const u32 *)&ip[8];
+	hash ^= hash_ptr(table, 32);
+	return this_cpu_ptr(&lookup_cache[hash_32(hash, LOOKUP_CACHE_BITS)]);
+}
+
+/* Returns a strong reference to a peer */
+static struct wg_peer *cached_lookup(struct allowedips *table,
+				     struct allowedips_node __rcu *root,
+				     u8 bits, const void *be_ip)
+{
+	/* Aligned so it can be passed to fls/fls64 */
+	u8 ip[16] __aligned(__alignof(u64));
+	struct lookup_cache_entry *entry;
+	struct allowedips_node *node;
 	struct wg_peer *peer = NULL;
+	u64 seq;
 
 	swap_endian(ip, be_ip, bits);
 
 	rcu_read_lock_bh();
-retry:
-	node = find_node(rcu_dereference_bh(root), bits, ip);
-	if (node) {
+	seq = READ_ONCE(table->seq);
+	smp_rmb();
+	entry = cache_slot(table, ip, bits);
+	if (entry->table == table && entry->seq == seq &&
+	    entry->bits == bits && !memcmp(entry->ip, ip, bits / 8U)) {
+		node = entry->node;
 		peer = wg_peer_get_maybe_zero(rcu_dereference_bh(node->peer));
-		if (!peer)
-			goto retry;
+		if (peer)
+			goto out;
+	}
+	peer = find_peer(root, bits, ip, &node);
+	if (peer) {
+		entry->table = table;
+		entry->node = node;
+		entry->seq = seq;
+		entry->bits = bits;
+		memcpy(entry->ip, ip, bits / 8U);
 	}
+out:
 	rcu_read_unlock_bh();
 	return peer;
 }
@@ -249,16 +346,17 @@ static int add(struct allowedips_node __rcu **trie, u8 bits, const u8 *key,
 void wg_allowedips_init(struct allowedips *table)
 {
 	table->root4 = table->root6 = NULL;
-	table->seq = 1;
+	table->seq = atomic64_inc_return(&table_seq);
 }
 
 void wg_allowedips_free(struct allowedips *table, struct mutex *lock)
 {
 	struct allowedips_node __rcu *old4 = table->root4, *old6 = table->root6;
 
-	++table->seq;
+	bump_seq(table);
 	RCU_INIT_POINTER(table->root4, NULL);
 	RCU_INIT_POINTER(table->root6, NULL);
+	bump_seq(table);
 	if (rcu_access_pointer(old4)) {
 		struct allowedips_node *node = rcu_dereference_protected(old4,
 							lockdep_is_held(lock));
@@ -280,10 +378,13 @@ int wg_allowedips_insert_v4(struct allowedips *table, const struct in_addr *ip,
 {
 	/* Aligned so it can be passed to fls */
 	u8 key[4] __aligned(__alignof(u32));
+	int ret;
 
-	++table->seq;
 	swap_endian(key, (const u8 *)ip, 32);
-	return add(&table->root4, 32, key, cidr, peer, lock);
+	bump_seq(table);
+	ret = add(&table->root4, 32, key, cidr, peer, lock);
+	bump_seq(table);
+	return ret;
 }
 
 int wg_allowedips_insert_v6(struct allowedips *table, const struct in6_addr *ip,
@@ -291,10 +392,13 @@ int wg_allowedips_insert_v6(struct allowedips *table, const struct in6_addr *ip,
 {
 	/* Aligned so it can be passed to fls64 */
 	u8 key[16] __aligned(__alignof(u64));
+	int ret;
 
-	++table->seq;
 	swap_endian(key, (const u8 *)ip, 128);
-	return add(&table->root6, 128, key, cidr, peer, lock);
+	bump_seq(table);
+	ret = add(&table->root6, 128, key, cidr, peer, lock);
+	bump_seq(table);
+	return ret;
 }
 
 void wg_allowedips_remove_by_peer(struct allowedips *table,
@@ -305,7 +409,7 @@ void wg_allowedips_remove_by_peer(struct allowedips *table,
 
 	if (list_empty(&peer->allowedips_list))
 		return;
-	++table->seq;
+	bump_seq(table);
 	list_for_each_entry_safe(node, tmp, &peer->allowedips_list, peer_list) {
 		list_del_init(&node->peer_list);
 		RCU_INIT_POINTER(node->peer, NULL);
@@ -335,6 +439,7 @@ void wg_allowedips_remove_by_peer(struct allowedips *table,
 		*(struct allowedips_node **)(parent->parent_bit_packed & ~3UL) = child;
 		call_rcu(&parent->rcu, node_free_rcu);
 	}
+	bump_seq(table);
 }
 
 int wg_allowedips_read_node(struct allowedips_node *node, u8 ip[16], u8 *cidr)
@@ -354,9 +459,11 @@ struct wg_peer *wg_allowedips_lookup_dst(struct allowedips *table,
 					 struct sk_buff *skb)
 {
 	if (skb->protocol == htons(ETH_P_IP))
-		return lookup(table->root4, 32, &ip_hdr(skb)->daddr);
+		return cached_lookup(table, table->root4, 32,
+				     &ip_hdr(skb)->daddr);
 	else if (skb->protocol == htons(ETH_P_IPV6))
-		return lookup(table->root6, 128, &ipv6_hdr(skb)->daddr);
+		return cached_lookup(table, table->root6, 128,
+				     &ipv6_hdr(skb)->daddr);
 	return NULL;
 }
 
@@ -365,9 +472,11 @@ struct wg_peer *wg_allowedips_lookup_src(struct allowedips *table,
 					 struct sk_buff *skb)
 {
 	if (skb->protocol == htons(ETH_P_IP))
-		return lookup(table->root4, 32, &ip_hdr(skb)->saddr);
+		return cached_lookup(table, table->root4, 32,
+				     &ip_hdr(skb)->saddr);
 	else if (skb->protocol == htons(ETH_P_IPV6))
-		return lookup(table->root6, 128, &ipv6_hdr(skb)->saddr);
+		return cached_lookup(table, table->root6, 128,
+				     &ipv6_hdr(skb)->saddr);
 	return NULL;
 }
 
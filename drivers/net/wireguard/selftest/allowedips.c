@@ -481,6 +481,14 @@ static __init struct wg_peer *init_peer(void)
 		maybe_fail();                                                \
 	} while (0)
 
+#define test_cached(version, mem, ipa, ipb, ipc, ipd) do {                   \
+		bool _s = cached_lookup(&t, t.root##version,                 \
+					(version) == 4 ? 32 : 128,           \
+					ip##version(ipa, ipb, ipc, ipd)) ==  \
+			  (mem);                                             \
+		maybe_fail();                                                \
+	} while (0)
+
 #define test_boolean(cond) do {   \
 		bool _s = (cond); \
 		maybe_fail();     \
@@ -579,12 +587,22 @@ bool __init wg_allowedips_selftest(void)
 	insert(4, a, 128, 0, 0, 0, 32);
 	insert(4, a, 192, 0, 0, 0, 32);
 	insert(4, a, 255, 0, 0, 0, 32);
+	test_cached(4, a, 64, 0, 0, 0);
+	test_cached(4, a, 64, 0, 0, 0);
 	wg_allowedips_remove_by_peer(&t, a, &mutex);
 	test_negative(4, a, 1, 0, 0, 0);
 	test_negative(4, a, 64, 0, 0, 0);
 	test_negative(4, a, 128, 0, 0, 0);
 	test_negative(4, a, 192, 0, 0, 0);
 	test_negative(4, a, 255, 0, 0, 0);
+	/* The cached result for 64.0.0.0 must not survive the removal. */
+	test_cached(4, e, 64, 0, 0, 0);
+	insert(4, b, 64, 0, 0, 0, 32);
+	test_cached(4, b, 64, 0, 0, 0);
+	insert(6, a, 0x24046800, 0x40040800, 0xdeadbeef, 0xdeadbeef, 128);
+	test_cached(6, a, 0x24046800, 0x40040800, 0xdeadbeef, 0xdeadbeef);
+	insert(6, c, 0x24046800, 0x40040800, 0xdeadbeef, 0xdeadbeef, 128);
+	test_cached(6, c, 0x24046800, 0x40040800, 0xdeadbeef, 0xdeadbeef);
 
 	wg_allowedips_free(&t, &mutex);
 	wg_allowedips_init(&t);
@@ -241,19 +241,10 @@ void wg_packet_send_keepalive(struct wg_peer *peer)
 
 static void wg_packet_create_data_done(struct wg_peer *peer, struct sk_buff *first)
 {
-	struct sk_buff *skb, *next;
-	bool is_keepalive, data_sent = false;
-
 	wg_timers_any_authenticated_packet_traversal(peer);
 	wg_timers_any_authenticated_packet_sent(peer);
-	skb_list_walk_safe(first, skb, next) {
-		is_keepalive = skb->len == message_data_len(0);
-		if (likely(!wg_socket_send_skb_to_peer(peer, skb,
-				PACKET_CB(skb)->ds) && !is_keepalive))
-			data_sent = true;
-	}
 
-	if (likely(data_sent))
+	if (likely(wg_socket_send_skb_list_to_peer(peer, first)))
 		wg_timers_data_sent(peer);
 
 	keep_key_fresh(peer);
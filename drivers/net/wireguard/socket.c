@@ -165,20 +165,26 @@ static int send6(struct wg_device *wg, struct sk_buff *skb,
 #endif
 }
 
+/* Must be called with peer->endpoint_lock held for reading. */
+static int send_to_endpoint(struct wg_peer *peer, struct sk_buff *skb, u8 ds)
+{
+	if (peer->endpoint.addr.sa_family == AF_INET)
+		return send4(peer->device, skb, &peer->endpoint, ds,
+			     &peer->endpoint_cache);
+	if (peer->endpoint.addr.sa_family == AF_INET6)
+		return send6(peer->device, skb, &peer->endpoint, ds,
+			     &peer->endpoint_cache);
+	dev_kfree_skb(skb);
+	return -EAFNOSUPPORT;
+}
+
 int wg_socket_send_skb_to_peer(struct wg_peer *peer, struct sk_buff *skb, u8 ds)
 {
 	size_t skb_len = skb->len;
-	int ret = -EAFNOSUPPORT;
+	int ret;
 
 	read_lock_bh(&peer->endpoint_lock);
-	if (peer->endpoint.addr.sa_family == AF_INET)
-		ret = send4(peer->device, skb, &peer->endpoint, ds,
-			    &peer->endpoint_cache);
-	else if (peer->endpoint.addr.sa_family == AF_INET6)
-		ret = send6(peer->device, skb, &peer->endpoint, ds,
-			    &peer->endpoint_cache);
-	else
-		dev_kfree_skb(skb);
+	ret = send_to_endpoint(peer, skb, ds);
 	if (likely(!ret))
 		peer->tx_bytes += skb_len;
 	read_unlock_bh(&peer->endpoint_lock);
@@ -186,6 +192,33 @@ int wg_socket_send_skb_to_peer(struct wg_peer *peer, struct sk_buff *skb, u8 ds)
 	return ret;
 }
 
+/* Sends every packet of a list, such as the segments of one GSO skb, while
+ * taking the endpoint lock only once, and returns the number of non-keepalive
+ * packets that were handed to the network stack.
+ */
+unsigned int wg_socket_send_skb_list_to_peer(struct wg_peer *peer,
+					     struct sk_buff *first)
+{
+	struct sk_buff *skb, *next;
+	unsigned int data_sent = 0;
+	size_t tx_bytes = 0;
+
+	read_lock_bh(&peer->endpoint_lock);
+	skb_list_walk_safe(first, skb, next) {
+		size_t skb_len = skb->len;
+
+		if (likely(!send_to_endpoint(peer, skb, PACKET_CB(skb)->ds))) {
+			tx_bytes += skb_len;
+			if (skb_len != message_data_len(0))
+				++data_sent;
+		}
+	}
+	peer->tx_bytes += tx_bytes;
+	read_unlock_bh(&peer->endpoint_lock);
+
+	return data_sent;
+}
+
 int wg_socket_send_buffer_to_peer(struct wg_peer *peer, void *buffer,
 				  size_t len, u8 ds)
 {
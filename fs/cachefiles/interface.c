@@ -361,6 +361,8 @@ void cachefiles_put_object(struct fscache_object *_object,
 			object->lookup_data = NULL;
 		}
 
+		cachefiles_forget_content(object);
+
 		cache = object->fscache.cache;
 		fscache_object_destroy(&object->fscache);
 		kmem_cache_free(cachefiles_object_jar, object);
@@ -455,6 +457,7 @@ static int cachefiles_attr_changed(struct fscache_object *_object)
 	ASSERT(d_is_reg(object->backer));
 
 	fscache_set_store_limit(&object->fscache, ni_size);
+	cachefiles_reset_content(object);
 
 	oi_size = i_size_read(d_backing_inode(object->backer));
 	if (oi_size == ni_size)
@@ -518,6 +521,7 @@ static void cachefiles_invalidate_object(struct fscache_operation *op)
 		ASSERT(d_is_reg(object->backer));
 
 		fscache_set_store_limit(&object->fscache, ni_size);
+		cachefiles_reset_content(object);
 
 		path.dentry = object->backer;
 		path.mnt = cache->mnt;
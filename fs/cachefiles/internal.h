@@ -38,6 +38,7 @@ struct cachefiles_object {
 	struct dentry			*dentry;	/* the file/dir representing this object */
 	struct dentry			*backer;	/* backing file */
 	loff_t				i_size;		/* object size */
+	struct cachefiles_content_map	*content_map;	/* pages known to be stored */
 	unsigned long			flags;
 #define CACHEFILES_OBJECT_ACTIVE	0		/* T if marked active */
 	atomic_t			usage;		/* object usage count */
@@ -194,6 +195,8 @@ extern int cachefiles_allocate_pages(struct fscache_retrieval *,
 				     struct list_head *, unsigned *, gfp_t);
 extern int cachefiles_write_page(struct fscache_storage *, struct page *);
 extern void cachefiles_uncache_page(struct fscache_object *, struct page *);
+extern void cachefiles_forget_content(struct cachefiles_object *);
+extern void cachefiles_reset_content(struct cachefiles_object *);
 
 /*
  * rdwr2.c
@@ -9,8 +9,122 @@
 #include <linux/slab.h>
 #include <linux/file.h>
 #include <linux/swap.h>
+#include <linux/sched/mm.h>
+#include <linux/bitmap.h>
 #include "internal.h"
 
+/*
+ * In-memory map of the backing file pages that are known to hold data.
+ *
+ * Presence used to be checked with bmap() on every page of every read, which
+ * is a full block mapping lookup in the backing filesystem each time.  Pages
+ * that bmap() has found, or that we have written ourselves, are remembered
+ * here so that reading them again needs only a bit test.  Only presence is
+ * cached, never absence, so a page missing from the map still falls back to
+ * bmap().  The map is allocated when the object is looked up and replaced
+ * whenever the backing file is truncated, which FS-Cache does with reads and
+ * writes excluded.  If it can't be allocated then, the object just keeps
+ * using bmap() until the next resize.
+ */
+#define CACHEFILES_CONTENT_MAP_MAX_PAGES	(1UL << 20)
+
+struct cachefiles_content_map {
+	pgoff_t		nr_pages;
+	unsigned long	present[];
+};
+
+static bool cachefiles_page_present(struct cachefiles_object *object,
+				    pgoff_t index)
+{
+	struct cachefiles_content_map *map = READ_ONCE(object->content_map);
+
+	return map && index < map->nr_pages && test_bit(index, map->present);
+}
+
+static void cachefiles_mark_present(struct cachefiles_object *object,
+				    pgoff_t index)
+{
+	struct cachefiles_content_map *map = READ_ONCE(object->content_map);
+
+	if (map && index < map->nr_pages)
+		set_bit(index, map->present);
+}
+
+/*
+ * Forget everything known about the content of the backing file
+ * - the caller must exclude reads and writes on the object
+ */
+void cachefiles_forget_content(struct cachefiles_object *object)
+{
+	kvfree(object->content_map);
+	WRITE_ONCE(object->content_map, NULL);
+}
+
+/*
+ * Start a new, empty content map sized from the object's store limit
+ * - the caller must exclude reads and writes on the object
+ */
+void cachefiles_reset_content(struct cachefiles_object *object)
+{
+	struct cachefiles_content_map *map;
+	pgoff_t nr_pages = object->fscache.store_limit;
+	unsigned int nofs;
+
+	cachefiles_forget_content(object);
+
+	if (!nr_pages || nr_pages > CACHEFILES_CONTENT_MAP_MAX_PAGES)
+		return;
+
+	/*
+	 * GFP_KERNEL lets kvzalloc() fall back to vmalloc for large maps, but
+	 * reclaim must not recurse into filesystems from here, as it could
+	 * end up waiting on fscache page writes.
+	 */
+	nofs = memalloc_nofs_save();
+	map = kvzalloc(struct_size(map, present, BITS_TO_LONGS(nr_pages)),
+		       GFP_KERNEL);
+	memalloc_nofs_restore(nofs);
+	if (!map)
+		return;
+	map->nr_pages = nr_pages;
+
+	WRITE_ONCE(object->content_map, map);
+}
+
+/*
+ * Find out whether the backing file holds data for a page
+ * - we assume the absence or presence of the first block is a good enough
+ *   indication for the page as a whole
+ * - TODO: don't use bmap() for this as it is _not_ actually good enough for
+ *   this as it doesn't indicate errors, but it's all we've got for the moment
+ */
+static bool cachefiles_backing_has_page(struct cachefiles_object *object,
+					struct inode *inode, pgoff_t index)
+{
+	unsigned shift = PAGE_SHIFT - inode->i_sb->s_blocksize_bits;
+	sector_t block;
+	int ret;
+
+	if (cachefiles_page_present(object, index))
+		return true;
+
+	block = index;
+	block <<= shift;
+
+	ret = bmap(inode, &block);
+	ASSERT(ret == 0);
+
+	_debug("%llx -> %llx",
+	       (unsigned long long) (index << shift),
+	       (unsigned long long) block);
+
+	if (!block)
+		return false;
+
+	cachefiles_mark_present(object, index);
+	return true;
+}
+
 /*
  * detect wake up events generated by the unlocking of pages in which we're
  * interested
@@ -396,9 +510,7 @@ int cachefiles_read_or_alloc_page(struct fscache_retrieval *op,
 	struct cachefiles_object *object;
 	struct cachefiles_cache *cache;
 	struct inode *inode;
-	sector_t block;
-	unsigned shift;
-	int ret, ret2;
+	int ret;
 
 	object = container_of(op->op.object,
 			      struct cachefiles_object, fscache);
@@ -413,30 +525,11 @@ int cachefiles_read_or_alloc_page(struct fscache_retrieval *op,
 	inode = d_backing_inode(object->backer);
 	ASSERT(S_ISREG(inode->i_mode));
 
-	/* calculate the shift required to use bmap */
-	shift = PAGE_SHIFT - inode->i_sb->s_blocksize_bits;
-
 	op->op.flags &= FSCACHE_OP_KEEP_FLAGS;
 	op->op.flags |= FSCACHE_OP_ASYNC;
 	op->op.processor = cachefiles_read_copier;
 
-	/* we assume the absence or presence of the first block is a good
-	 * enough indication for the page as a whole
-	 * - TODO: don't use bmap() for this as it is _not_ actually good
-	 *   enough for this as it doesn't indicate errors, but it's all we've
-	 *   got for the moment
-	 */
-	block = page->index;
-	block <<= shift;
-
-	ret2 = bmap(inode, &block);
-	ASSERT(ret2 == 0);
-
-	_debug("%llx -> %llx",
-	       (unsigned long long) (page->index << shift),
-	       (unsigned long long) block);
-
-	if (block) {
+	if (cachefiles_backing_has_page(object, inode, page->index)) {
 		/* submit the apparently valid page to the backing fs to be
 		 * read from disk */
 		ret = cachefiles_read_backing_file_one(object, op, page);
@@ -690,7 +783,7 @@ int cachefiles_read_or_alloc_pages(struct fscache_retrieval *op,
 	struct pagevec pagevec;
 	struct inode *inode;
 	struct page *page, *_n;
-	unsigned shift, nrbackpages;
+	unsigned nrbackpages;
 	int ret, ret2, space;
 
 	object = container_of(op->op.object,
@@ -712,9 +805,6 @@ int cachefiles_read_or_alloc_pages(struct fscache_retrieval *op,
 	inode = d_backing_inode(object->backer);
 	ASSERT(S_ISREG(inode->i_mode));
 
-	/* calculate the shift required to use bmap */
-	shift = PAGE_SHIFT - inode->i_sb->s_blocksize_bits;
-
 	pagevec_init(&pagevec);
 
 	op->op.flags &= FSCACHE_OP_KEEP_FLAGS;
@@ -726,25 +816,7 @@ int cachefiles_read_or_alloc_pages(struct fscache_retrieval *op,
 
 	ret = space ? -ENODATA : -ENOBUFS;
 	list_for_each_entry_safe(page, _n, pages, lru) {
-		sector_t block;
-
-		/* we assume the absence or presence of the first block is a
-		 * good enough indication for the page as a whole
-		 * - TODO: don't use bmap() for this as it is _not_ actually
-		 *   good enough for this as it doesn't indicate errors, but
-		 *   it's all we've got for the moment
-		 */
-		block = page->index;
-		block <<= shift;
-
-		ret2 = bmap(inode, &block);
-		ASSERT(ret2 == 0);
-
-		_debug("%llx -> %llx",
-		       (unsigned long long) (page->index << shift),
-		       (unsigned long long) block);
-
-		if (block) {
+		if (cachefiles_backing_has_page(object, inode, page->index)) {
 			/* we have data - add it to the list to give to the
 			 * backing fs */
 			list_move(&page->lru, &backpages);
@@ -941,6 +1013,7 @@ int cachefiles_write_page(struct fscache_storage *op, struct page *page)
 	if (ret != len)
 		goto error_eio;
 
+	cachefiles_mark_present(object, page->index);
 	_leave(" = 0");
 	return 0;
 
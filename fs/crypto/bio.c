@@ -27,19 +27,36 @@
  *
  * This function sets PG_error on any pages that contain any blocks that failed
  * to be decrypted.  The filesystem must not mark such pages uptodate.
+ *
+ * All the pages belong to the same file, so a single crypto request is
+ * allocated up front and reused for every block in the bio.
  */
 void fscrypt_decrypt_bio(struct bio *bio)
 {
+	const struct inode *inode = bio_first_page_all(bio)->mapping->host;
+	struct skcipher_request *req;
 	struct bio_vec *bv;
 	struct bvec_iter_all iter_all;
 
+	req = skcipher_request_alloc(inode->i_crypt_info->ci_enc_key.tfm,
+				     GFP_NOFS);
+
 	bio_for_each_segment_all(bv, bio, iter_all) {
 		struct page *page = bv->bv_page;
-		int ret = fscrypt_decrypt_pagecache_blocks(page, bv->bv_len,
-							   bv->bv_offset);
+		int ret;
+
+		if (req)
+			ret = fscrypt_decrypt_pagecache_blocks_req(req, page,
+								   bv->bv_len,
+								   bv->bv_offset);
+		else
+			ret = fscrypt_decrypt_pagecache_blocks(page, bv->bv_len,
+							       bv->bv_offset);
 		if (ret)
 			SetPageError(page);
 	}
+
+	skcipher_request_free(req);
 }
 EXPORT_SYMBOL(fscrypt_decrypt_bio);
 
@@ -97,18 +97,21 @@ void fscrypt_generate_iv(union fscrypt_iv *iv, u64 lblk_num,
 	iv->lblk_num = cpu_to_le64(lblk_num);
 }
 
-/* Encrypt or decrypt a single filesystem block of file contents */
-int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
-			u64 lblk_num, struct page *src_page,
-			struct page *dest_page, unsigned int len,
-			unsigned int offs, gfp_t gfp_flags)
+/*
+ * Encrypt or decrypt a single filesystem block of file contents, using a
+ * request allocated by the caller for the inode's contents key.  The request
+ * can be reused for any number of blocks of the same inode.
+ */
+int fscrypt_crypt_block_req(struct skcipher_request *req,
+			    const struct inode *inode, fscrypt_direction_t rw,
+			    u64 lblk_num, struct page *src_page,
+			    struct page *dest_page, unsigned int len,
+			    unsigned int offs)
 {
 	union fscrypt_iv iv;
-	struct skcipher_request *req = NULL;
 	DECLARE_CRYPTO_WAIT(wait);
 	struct scatterlist dst, src;
 	struct fscrypt_info *ci = inode->i_crypt_info;
-	struct crypto_skcipher *tfm = ci->ci_enc_key.tfm;
 	int res = 0;
 
 	if (WARN_ON_ONCE(len <= 0))
@@ -118,10 +121,6 @@ int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
 
 	fscrypt_generate_iv(&iv, lblk_num, ci);
 
-	req = skcipher_request_alloc(tfm, gfp_flags);
-	if (!req)
-		return -ENOMEM;
-
 	skcipher_request_set_callback(
 		req, CRYPTO_TFM_REQ_MAY_BACKLOG | CRYPTO_TFM_REQ_MAY_SLEEP,
 		crypto_req_done, &wait);
@@ -135,7 +134,6 @@ int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
 		res = crypto_wait_req(crypto_skcipher_decrypt(req), &wait);
 	else
 		res = crypto_wait_req(crypto_skcipher_encrypt(req), &wait);
-	skcipher_request_free(req);
 	if (res) {
 		fscrypt_err(inode, "%scryption failed for block %llu: %d",
 			    (rw == FS_DECRYPT ? "De" : "En"), lblk_num, res);
@@ -144,6 +142,26 @@ int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
 	return 0;
 }
 
+/* Encrypt or decrypt a single filesystem block of file contents */
+int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
+			u64 lblk_num, struct page *src_page,
+			struct page *dest_page, unsigned int len,
+			unsigned int offs, gfp_t gfp_flags)
+{
+	struct skcipher_request *req;
+	int res;
+
+	req = skcipher_request_alloc(inode->i_crypt_info->ci_enc_key.tfm,
+				     gfp_flags);
+	if (!req)
+		return -ENOMEM;
+
+	res = fscrypt_crypt_block_req(req, inode, rw, lblk_num, src_page,
+				      dest_page, len, offs);
+	skcipher_request_free(req);
+	return res;
+}
+
 /**
  * fscrypt_encrypt_pagecache_blocks() - Encrypt filesystem blocks from a
  *					pagecache page
@@ -254,6 +272,29 @@ EXPORT_SYMBOL(fscrypt_encrypt_block_inplace);
  */
 int fscrypt_decrypt_pagecache_blocks(struct page *page, unsigned int len,
 				     unsigned int offs)
+{
+	const struct inode *inode = page->mapping->host;
+	struct skcipher_request *req;
+	int err;
+
+	req = skcipher_request_alloc(inode->i_crypt_info->ci_enc_key.tfm,
+				     GFP_NOFS);
+	if (!req)
+		return -ENOMEM;
+
+	err = fscrypt_decrypt_pagecache_blocks_req(req, page, len, offs);
+	skcipher_request_free(req);
+	return err;
+}
+EXPORT_SYMBOL(fscrypt_decrypt_pagecache_blocks);
+
+/*
+ * Like fscrypt_decrypt_pagecache_blocks(), but using a request allocated by
+ * the caller, so that a whole bio can be decrypted with a single request.
+ */
+int fscrypt_decrypt_pagecache_blocks_req(struct skcipher_request *req,
+					 struct page *page, unsigned int len,
+					 unsigned int offs)
 {
 	const struct inode *inode = page->mapping->host;
 	const unsigned int blockbits = inode->i_blkbits;
@@ -270,14 +311,13 @@ int fscrypt_decrypt_pagecache_blocks(struct page *page, unsigned int len,
 		return -EINVAL;
 
 	for (i = offs; i < offs + len; i += blocksize, lblk_num++) {
-		err = fscrypt_crypt_block(inode, FS_DECRYPT, lblk_num, page,
-					  page, blocksize, i, GFP_NOFS);
+		err = fscrypt_crypt_block_req(req, inode, FS_DECRYPT, lblk_num,
+					      page, page, blocksize, i);
 		if (err)
 			return err;
 	}
 	return 0;
 }
-EXPORT_SYMBOL(fscrypt_decrypt_pagecache_blocks);
 
 /**
  * fscrypt_decrypt_block_inplace() - Decrypt a filesystem block in-place
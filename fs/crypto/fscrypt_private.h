@@ -14,6 +14,7 @@
 #include <linux/fscrypt.h>
 #include <linux/siphash.h>
 #include <crypto/hash.h>
+#include <crypto/skcipher.h>
 #include <linux/blk-crypto.h>
 
 #define CONST_STRLEN(str)	(sizeof(str) - 1)
@@ -267,10 +268,18 @@ typedef enum {
 /* crypto.c */
 extern struct kmem_cache *fscrypt_info_cachep;
 int fscrypt_initialize(unsigned int cop_flags);
+int fscrypt_crypt_block_req(struct skcipher_request *req,
+			    const struct inode *inode, fscrypt_direction_t rw,
+			    u64 lblk_num, struct page *src_page,
+			    struct page *dest_page, unsigned int len,
+			    unsigned int offs);
 int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
 			u64 lblk_num, struct page *src_page,
 			struct page *dest_page, unsigned int len,
 			unsigned int offs, gfp_t gfp_flags);
+int fscrypt_decrypt_pagecache_blocks_req(struct skcipher_request *req,
+					 struct page *page, unsigned int len,
+					 unsigned int offs);
 struct page *fscrypt_alloc_bounce_page(gfp_t gfp_flags);
 
 void __printf(3, 4) __cold
@@ -234,6 +234,92 @@ unsigned int exfat_find_free_bitmap(struct super_block *sb, unsigned int clu)
 	return EXFAT_EOF_CLUSTER;
 }
 
+/*
+ * Return the first bitmap entry in [ent, end) whose bit equals @used, or
+ * @end if there is none.  Works a whole bitmap sector at a time.
+ */
+static unsigned int exfat_bitmap_next(struct super_block *sb, unsigned int ent,
+		unsigned int end, bool used)
+{
+	struct exfat_sb_info *sbi = EXFAT_SB(sb);
+	unsigned int base, size, off;
+	void *map;
+
+	while (ent < end) {
+		base = ent & ~BITS_PER_SECTOR_MASK(sb);
+		size = min_t(unsigned int, BITS_PER_SECTOR(sb), end - base);
+		map = sbi->vol_amap[BITMAP_OFFSET_SECTOR_INDEX(sb, ent)]->b_data;
+
+		if (used)
+			off = find_next_bit_le(map, size, ent - base);
+		else
+			off = find_next_zero_bit_le(map, size, ent - base);
+		if (off < size)
+			return base + off;
+
+		ent = base + size;
+	}
+
+	return end;
+}
+
+static bool exfat_find_free_run(struct super_block *sb, unsigned int ent,
+		unsigned int end, unsigned int len, unsigned int *best,
+		unsigned int *best_len)
+{
+	unsigned int free, used;
+
+	while (ent < end) {
+		free = exfat_bitmap_next(sb, ent, end, false);
+		if (free >= end)
+			break;
+
+		used = exfat_bitmap_next(sb, free, end, true);
+		if (used - free > *best_len) {
+			*best = free;
+			*best_len = used - free;
+			if (*best_len >= len)
+				return true;
+		}
+		ent = used;
+	}
+
+	return false;
+}
+
+/*
+ * Find a run of at least @len free clusters, looking at no more than
+ * EXFAT_ALLOC_SCAN_MAX bitmap entries from "clu" onwards (wrapping to the
+ * start of the cluster heap).  If there is no run that long in that window,
+ * the start of the longest run seen is returned instead.  EXFAT_EOF_CLUSTER
+ * means the window had no free cluster at all, and the caller should fall
+ * back to exfat_find_free_bitmap().
+ */
+unsigned int exfat_find_free_extent(struct super_block *sb, unsigned int clu,
+		unsigned int len)
+{
+	struct exfat_sb_info *sbi = EXFAT_SB(sb);
+	unsigned int nr_ents = EXFAT_DATA_CLUSTER_COUNT(sbi);
+	unsigned int start, end, scan, best = 0, best_len = 0;
+
+	WARN_ON(clu < EXFAT_FIRST_CLUSTER);
+	start = CLUSTER_TO_BITMAP_ENT(clu);
+	if (start >= nr_ents)
+		start = 0;
+
+	scan = min_t(unsigned int, nr_ents, EXFAT_ALLOC_SCAN_MAX);
+	end = nr_ents - start > scan ? start + scan : nr_ents;
+
+	if (!exfat_find_free_run(sb, start, end, len, &best, &best_len) &&
+	    end - start < scan)
+		exfat_find_free_run(sb, 0, scan - (end - start), len, &best,
+				&best_len);
+
+	if (!best_len)
+		return EXFAT_EOF_CLUSTER;
+	return BITMAP_ENT_TO_CLUSTER(best);
+}
+
 int exfat_count_used_clusters(struct super_block *sb, unsigned int *ret_count)
 {
 	struct exfat_sb_info *sbi = EXFAT_SB(sb);
@@ -74,6 +74,8 @@ enum {
 
 #define EXFAT_HINT_NONE		-1
 #define EXFAT_MIN_SUBDIR	2
+#define EXFAT_ALLOC_EXTENT_MIN	16 /* min clusters for a new fragment */
+#define EXFAT_ALLOC_SCAN_MAX	65536 /* max bitmap entries per extent search */
 
 /*
  * helpers for cluster size to byte conversion.
@@ -411,6 +413,8 @@ void exfat_free_bitmap(struct exfat_sb_info *sbi);
 int exfat_set_bitmap(struct inode *inode, unsigned int clu, bool sync);
 void exfat_clear_bitmap(struct inode *inode, unsigned int clu, bool sync);
 unsigned int exfat_find_free_bitmap(struct super_block *sb, unsigned int clu);
+unsigned int exfat_find_free_extent(struct super_block *sb, unsigned int clu,
+		unsigned int len);
 int exfat_count_used_clusters(struct super_block *sb, unsigned int *ret_count);
 int exfat_trim_fs(struct inode *inode, struct fstrim_range *range);
 
@@ -312,12 +312,33 @@ int exfat_zeroed_cluster(struct inode *dir, unsigned int clu)
 	return 0;
 }
 
+/*
+ * Pick the next cluster to allocate.  A free "hint_clu" keeps the chain
+ * contiguous.  Otherwise the chain has to be fragmented anyway, so start the
+ * new fragment at a free extent near the hint that can hold "want" clusters
+ * instead of at the first free cluster, which is often a small hole.  The
+ * extent search is bounded; if it finds nothing, use the first free cluster.
+ */
+static unsigned int exfat_find_alloc_cluster(struct super_block *sb,
+		unsigned int hint_clu, unsigned int want)
+{
+	unsigned int clu = exfat_find_free_bitmap(sb, hint_clu);
+	unsigned int ext;
+
+	if (clu == hint_clu || clu == EXFAT_EOF_CLUSTER || want <= 1)
+		return clu;
+
+	ext = exfat_find_free_extent(sb, hint_clu, want);
+	return ext != EXFAT_EOF_CLUSTER ? ext : clu;
+}
+
 int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 		struct exfat_chain *p_chain, bool sync_bmap)
 {
 	int ret = -ENOSPC;
 	unsigned int num_clusters = 0, total_cnt;
 	unsigned int hint_clu, new_clu, last_clu = EXFAT_EOF_CLUSTER;
+	unsigned int want = num_alloc;
 	struct super_block *sb = inode->i_sb;
 	struct exfat_sb_info *sbi = EXFAT_SB(sb);
 
@@ -337,14 +358,22 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 
 	hint_clu = p_chain->dir;
 	/* find new cluster */
-	if (hint_clu == EXFAT_EOF_CLUSTER) {
+	if (hint_clu != EXFAT_EOF_CLUSTER) {
+		want = max_t(unsigned int, num_alloc, EXFAT_ALLOC_EXTENT_MIN);
+	} else {
 		if (sbi->clu_srch_ptr < EXFAT_FIRST_CLUSTER) {
 			exfat_err(sb, "sbi->clu_srch_ptr is invalid (%u)\n",
 				  sbi->clu_srch_ptr);
 			sbi->clu_srch_ptr = EXFAT_FIRST_CLUSTER;
 		}
 
-		hint_clu = exfat_find_free_bitmap(sb, sbi->clu_srch_ptr);
+		hint_clu = EXFAT_EOF_CLUSTER;
+		if (num_alloc > 1)
+			hint_clu = exfat_find_free_extent(sb, sbi->clu_srch_ptr,
+					num_alloc);
+		if (hint_clu == EXFAT_EOF_CLUSTER)
+			hint_clu = exfat_find_free_bitmap(sb,
+					sbi->clu_srch_ptr);
 		if (hint_clu == EXFAT_EOF_CLUSTER) {
 			ret = -ENOSPC;
 			goto unlock;
@@ -368,7 +397,7 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 
 	p_chain->dir = EXFAT_EOF_CLUSTER;
 
-	while ((new_clu = exfat_find_free_bitmap(sb, hint_clu)) !=
+	while ((new_clu = exfat_find_alloc_cluster(sb, hint_clu, want)) !=
 	       EXFAT_EOF_CLUSTER) {
 		if (new_clu != hint_clu &&
 		    p_chain->flags == ALLOC_NO_FAT_CHAIN) {
@@ -415,6 +444,8 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 			return 0;
 		}
 
+		/* later fragments only need room for what is left */
+		want = num_alloc;
 		hint_clu = new_clu + 1;
 		if (hint_clu >= sbi->num_clusters) {
 			hint_clu = EXFAT_FIRST_CLUSTER;
@@ -5,6 +5,7 @@
 #include <linux/init.h>
 #include <linux/jiffies.h>
 #include <linux/kernel.h> /* UINT_MAX */
+#include <linux/mm.h>
 #include <linux/mount.h>
 #include <linux/sched.h>
 #include <linux/sched/user.h>
@@ -176,6 +177,7 @@ static int fanotify_merge(struct fsnotify_group *group,
 			break;
 		if (fanotify_should_merge(old, new)) {
 			old->mask |= new->mask;
+			group->fanotify_data.nr_merged++;
 			return 1;
 		}
 	}
@@ -706,6 +708,7 @@ static void fanotify_insert_event(struct fsnotify_group *group,
 		 group, event, bucket);
 
 	hlist_add_head(&event->merge_list, hlist);
+	group->fanotify_data.nr_hashed++;
 }
 
 static int fanotify_handle_event(struct fsnotify_group *group, u32 mask,
@@ -772,8 +775,10 @@ static int fanotify_handle_event(struct fsnotify_group *group, u32 mask,
 		 * We don't queue overflow events for permission events as
 		 * there the access is denied and so no event is in fact lost.
 		 */
-		if (!fanotify_is_perm_event(mask))
+		if (!fanotify_is_perm_event(mask)) {
+			atomic_long_inc(&group->fanotify_data.nr_overflows);
 			fsnotify_queue_overflow(group);
+		}
 		goto finish;
 	}
 
@@ -784,6 +789,9 @@ static int fanotify_handle_event(struct fsnotify_group *group, u32 mask,
 	if (ret) {
 		/* Permission events shouldn't be merged */
 		BUG_ON(ret == 1 && mask & FANOTIFY_PERM_EVENTS);
+		/* 2 also means the group is shutting down, not an overflow */
+		if (ret == 2 && !READ_ONCE(group->shutdown))
+			atomic_long_inc(&group->fanotify_data.nr_overflows);
 		/* Our event wasn't used in the end. Free it. */
 		fsnotify_destroy_event(group, fsn_event);
 
@@ -801,7 +809,7 @@ static int fanotify_handle_event(struct fsnotify_group *group, u32 mask,
 
 static void fanotify_free_group_priv(struct fsnotify_group *group)
 {
-	kfree(group->fanotify_data.merge_hash);
+	kvfree(group->fanotify_data.merge_hash);
 	if (group->fanotify_data.ucounts)
 		dec_ucount(group->fanotify_data.ucounts,
 			   UCOUNT_FANOTIFY_GROUPS);
@@ -304,11 +304,12 @@ static inline struct path *fanotify_event_path(struct fanotify_event *event)
 }
 
 /*
- * Use 128 size hash table to speed up events merge.
+ * Use a hash table to speed up events merge.  The default queue gets 128
+ * buckets; larger queues get up to 4096 so that the bounded merge walk
+ * still covers a useful fraction of the queued events.
  */
 #define FANOTIFY_HTABLE_BITS	(7)
-#define FANOTIFY_HTABLE_SIZE	(1 << FANOTIFY_HTABLE_BITS)
-#define FANOTIFY_HTABLE_MASK	(FANOTIFY_HTABLE_SIZE - 1)
+#define FANOTIFY_HTABLE_MAX_BITS	(12)
 
 /*
  * Permission events and overflow event do not get merged - don't hash them.
@@ -322,5 +323,6 @@ static inline unsigned int fanotify_event_hash_bucket(
 						struct fsnotify_group *group,
 						struct fanotify_event *event)
 {
-	return event->hash & FANOTIFY_HTABLE_MASK;
+	return event->hash &
+		((1U << group->fanotify_data.merge_hash_bits) - 1);
 }
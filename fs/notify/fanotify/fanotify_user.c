@@ -1126,16 +1126,24 @@ static struct fsnotify_event *fanotify_alloc_overflow_event(void)
 	return &oevent->fse;
 }
 
-static struct hlist_head *fanotify_alloc_merge_hash(void)
+/*
+ * Size the merge hash table by the queue limit, so that a full queue has
+ * about FANOTIFY_MAX_MERGE_EVENTS events per bucket at most.
+ */
+static struct hlist_head *fanotify_alloc_merge_hash(unsigned int max_events,
+						    unsigned int *bits)
 {
 	struct hlist_head *hash;
 
-	hash = kmalloc(sizeof(struct hlist_head) << FANOTIFY_HTABLE_BITS,
-		       GFP_KERNEL_ACCOUNT);
+	*bits = clamp_t(unsigned int, order_base_2(max_events >> 7),
+			FANOTIFY_HTABLE_BITS, FANOTIFY_HTABLE_MAX_BITS);
+
+	hash = kvmalloc_array(1U << *bits, sizeof(struct hlist_head),
+			      GFP_KERNEL_ACCOUNT);
 	if (!hash)
 		return NULL;
 
-	__hash_init(hash, FANOTIFY_HTABLE_SIZE);
+	__hash_init(hash, 1U << *bits);
 
 	return hash;
 }
@@ -1231,12 +1239,6 @@ SYSCALL_DEFINE2(fanotify_init, unsigned int, flags, unsigned int, event_f_flags)
 	group->fanotify_data.flags = flags | internal_flags;
 	group->memcg = get_mem_cgroup_from_mm(current->mm);
 
-	group->fanotify_data.merge_hash = fanotify_alloc_merge_hash();
-	if (!group->fanotify_data.merge_hash) {
-		fd = -ENOMEM;
-		goto out_destroy_group;
-	}
-
 	group->overflow_event = fanotify_alloc_overflow_event();
 	if (unlikely(!group->overflow_event)) {
 		fd = -ENOMEM;
@@ -1272,6 +1274,14 @@ SYSCALL_DEFINE2(fanotify_init, unsigned int, flags, unsigned int, event_f_flags)
 		group->max_events = fanotify_max_queued_events;
 	}
 
+	group->fanotify_data.merge_hash =
+		fanotify_alloc_merge_hash(group->max_events,
+					  &group->fanotify_data.merge_hash_bits);
+	if (!group->fanotify_data.merge_hash) {
+		fd = -ENOMEM;
+		goto out_destroy_group;
+	}
+
 	if (flags & FAN_UNLIMITED_MARKS) {
 		fd = -EPERM;
 		if (!capable(CAP_SYS_ADMIN))
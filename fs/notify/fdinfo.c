@@ -146,6 +146,12 @@ void fanotify_show_fdinfo(struct seq_file *m, struct file *f)
 	seq_printf(m, "fanotify flags:%x event-flags:%x\n",
 		   group->fanotify_data.flags & FANOTIFY_INIT_FLAGS,
 		   group->fanotify_data.f_flags);
+	seq_printf(m, "fanotify queue q_len:%u max_events:%u merge_buckets:%u hashed:%lu merged:%lu overflows:%ld\n",
+		   READ_ONCE(group->q_len), group->max_events,
+		   1U << group->fanotify_data.merge_hash_bits,
+		   READ_ONCE(group->fanotify_data.nr_hashed),
+		   READ_ONCE(group->fanotify_data.nr_merged),
+		   atomic_long_read(&group->fanotify_data.nr_overflows));
 
 	show_fdinfo(m, f, fanotify_fdinfo);
 }
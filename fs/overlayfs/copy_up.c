@@ -19,6 +19,7 @@
 #include <linux/fdtable.h>
 #include <linux/ratelimit.h>
 #include <linux/exportfs.h>
+#include <linux/workqueue.h>
 #include "overlayfs.h"
 
 #define OVL_COPY_UP_CHUNK_SIZE (1 << 20)
@@ -37,6 +38,11 @@ static int ovl_ccup_get(char *buf, const struct kernel_param *param)
 module_param_call(check_copy_up, ovl_ccup_set, ovl_ccup_get, NULL, 0644);
 MODULE_PARM_DESC(check_copy_up, "Obsolete; does nothing");
 
+static bool ovl_async_data_copy_up __read_mostly;
+module_param_named(async_data_copy_up, ovl_async_data_copy_up, bool, 0644);
+MODULE_PARM_DESC(async_data_copy_up,
+		 "Copy up file data in the background after a metadata only copy up");
+
 static bool ovl_must_copy_xattr(const char *name)
 {
 	return !strcmp(name, XATTR_POSIX_ACL_ACCESS) ||
@@ -242,6 +248,12 @@ static int ovl_copy_up_data(struct ovl_fs *ofs, struct path *old,
 			break;
 		}
 
+		/* Abandon a background data copy up on unmount */
+		if (READ_ONCE(ofs->copyup_shutdown)) {
+			error = -EINTR;
+			break;
+		}
+
 		/*
 		 * Fill zero for hole will cost unnecessary disk space
 		 * and meanwhile slow down the copy-up speed, so we do
@@ -939,6 +951,129 @@ static int ovl_copy_up_meta_inode_data(struct ovl_copy_up_ctx *c)
 	return err;
 }
 
+/*
+ * With metacopy=on, a metadata only copy up leaves the data on the lower
+ * layer and the first open for write has to copy the whole file while the
+ * opener waits.  When async_data_copy_up is enabled, queue that data copy
+ * up to run in the background right after the metadata copy up.  Until it
+ * is done reads keep going to the lower data, as for any metacopy inode,
+ * and an opener for write waits on ovl_copy_up_start() only for the
+ * remainder.
+ *
+ * Each overlay has a single work item that copies the queued files one at
+ * a time with the mounter's credentials, and at most OVL_ASYNC_COPY_UP_MAX
+ * files are queued; beyond that, files are left to be copied up on open as
+ * before.  Queued files pin their dentry, so ovl_kill_sb() cancels them
+ * before the dcache is shrunk.
+ */
+#define OVL_ASYNC_COPY_UP_MAX	64
+
+struct ovl_data_copy_up_item {
+	struct list_head list;
+	struct dentry *dentry;
+};
+
+static struct ovl_data_copy_up_item *ovl_next_data_copy_up(struct ovl_fs *ofs)
+{
+	struct ovl_data_copy_up_item *item;
+
+	spin_lock(&ofs->copyup_lock);
+	item = list_first_entry_or_null(&ofs->copyup_list,
+					struct ovl_data_copy_up_item, list);
+	if (item) {
+		list_del(&item->list);
+		ofs->copyup_pending--;
+	}
+	spin_unlock(&ofs->copyup_lock);
+
+	return item;
+}
+
+static void ovl_data_copy_up_workfn(struct work_struct *work)
+{
+	struct ovl_fs *ofs = container_of(work, struct ovl_fs, copyup_work);
+	struct ovl_data_copy_up_item *item;
+	const struct cred *old_cred;
+	int err;
+
+	while ((item = ovl_next_data_copy_up(ofs))) {
+		old_cred = ovl_override_creds(item->dentry->d_sb);
+		err = ovl_want_write(item->dentry);
+		if (!err) {
+			err = ovl_copy_up_with_data(item->dentry);
+			ovl_drop_write(item->dentry);
+		}
+		revert_creds(old_cred);
+
+		if (err && !READ_ONCE(ofs->copyup_shutdown))
+			pr_warn_ratelimited("async data copy up failed (%pd2, err=%i)\n",
+					    item->dentry, err);
+
+		dput(item->dentry);
+		kfree(item);
+		cond_resched();
+	}
+}
+
+static void ovl_queue_data_copy_up(struct dentry *dentry, loff_t size)
+{
+	struct ovl_fs *ofs = OVL_FS(dentry->d_sb);
+	struct ovl_data_copy_up_item *item;
+
+	if (!READ_ONCE(ovl_async_data_copy_up) || !size)
+		return;
+
+	item = kmalloc(sizeof(*item), GFP_KERNEL);
+	if (!item)
+		return;
+	item->dentry = dget(dentry);
+
+	spin_lock(&ofs->copyup_lock);
+	if (ofs->copyup_pending < OVL_ASYNC_COPY_UP_MAX) {
+		list_add_tail(&item->list, &ofs->copyup_list);
+		ofs->copyup_pending++;
+		queue_work(system_unbound_wq, &ofs->copyup_work);
+		item = NULL;
+	}
+	spin_unlock(&ofs->copyup_lock);
+
+	if (item) {
+		dput(item->dentry);
+		kfree(item);
+	}
+}
+
+void ovl_init_data_copy_up(struct ovl_fs *ofs)
+{
+	spin_lock_init(&ofs->copyup_lock);
+	INIT_LIST_HEAD(&ofs->copyup_list);
+	INIT_WORK(&ofs->copyup_work, ovl_data_copy_up_workfn);
+}
+
+/*
+ * Drop the files that are still queued and abandon the one being copied,
+ * if any, leaving it a metacopy file.  Called when the overlay is being
+ * shut down.
+ */
+void ovl_cancel_data_copy_up(struct ovl_fs *ofs)
+{
+	struct ovl_data_copy_up_item *item, *tmp;
+	LIST_HEAD(list);
+
+	spin_lock(&ofs->copyup_lock);
+	WRITE_ONCE(ofs->copyup_shutdown, true);
+	list_splice_init(&ofs->copyup_list, &list);
+	ofs->copyup_pending = 0;
+	spin_unlock(&ofs->copyup_lock);
+
+	cancel_work_sync(&ofs->copyup_work);
+
+	list_for_each_entry_safe(item, tmp, &list, list) {
+		dput(item->dentry);
+		kfree(item);
+	}
+}
+
 static int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
 			   int flags)
 {
@@ -990,13 +1125,19 @@ static int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
 		if (err > 0)
 			err = 0;
 	} else {
-		if (!ovl_dentry_upper(dentry))
+		bool copied_meta = false;
+
+		if (!ovl_dentry_upper(dentry)) {
 			err = ovl_do_copy_up(&ctx);
+			copied_meta = !err && ctx.metacopy;
+		}
 		if (!err && parent && !ovl_dentry_has_upper_alias(dentry))
 			err = ovl_link_up(&ctx);
 		if (!err && ovl_dentry_needs_data_copy_up_locked(dentry, flags))
 			err = ovl_copy_up_meta_inode_data(&ctx);
 		ovl_copy_up_end(dentry);
+		if (!err && copied_meta)
+			ovl_queue_data_copy_up(dentry, ctx.stat.size);
 	}
 	do_delayed_call(&done);
 
@@ -84,6 +84,12 @@ struct ovl_fs {
 	struct dentry *whiteout;
 	/* r/o snapshot of upperdir sb's only taken on volatile mounts */
 	errseq_t errseq;
+	/* Pending background data copy ups (async_data_copy_up) */
+	spinlock_t copyup_lock;
+	struct list_head copyup_list;
+	unsigned int copyup_pending;
+	bool copyup_shutdown;
+	struct work_struct copyup_work;
 };
 
 static inline struct vfsmount *ovl_upper_mnt(struct ovl_fs *ofs)
@@ -2005,6 +2005,7 @@ static int ovl_fill_super(struct super_block *sb, void *data, int silent)
 	ofs = kzalloc(sizeof(struct ovl_fs), GFP_KERNEL);
 	if (!ofs)
 		goto out;
+	ovl_init_data_copy_up(ofs);
 
 	err = -ENOMEM;
 	ofs->creator_cred = cred = prepare_creds();
@@ -2183,12 +2184,24 @@ static struct dentry *ovl_mount(struct file_system_type *fs_type, int flags,
 	return mount_nodev(fs_type, flags, raw_data, ovl_fill_super);
 }
 
+/*
+ * Background data copy ups pin dentries, so they have to be cancelled
+ * before generic_shutdown_super() shrinks the dcache; ->put_super() would
+ * be too late.  s_root is only set once ovl_fill_super() has succeeded.
+ */
+static void ovl_kill_sb(struct super_block *sb)
+{
+	if (sb->s_root)
+		ovl_cancel_data_copy_up(OVL_FS(sb));
+	kill_anon_super(sb);
+}
+
 static struct file_system_type ovl_fs_type = {
 	.owner		= THIS_MODULE,
 	.name		= "overlay",
 	.fs_flags	= FS_USERNS_MOUNT,
 	.mount		= ovl_mount,
-	.kill_sb	= kill_anon_super,
+	.kill_sb	= ovl_kill_sb,
 };
 MODULE_ALIAS_FS("overlay");
 
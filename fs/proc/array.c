@@ -92,6 +92,7 @@
 #include <linux/string_helpers.h>
 #include <linux/user_namespace.h>
 #include <linux/fs_struct.h>
+#include <linux/pidstats.h>
 
 #include <asm/processor.h>
 #include "internal.h"
@@ -643,6 +644,61 @@ static int do_task_stat(struct seq_file *m, struct pid_namespace *ns,
 	return 0;
 }
 
+/*
+ * Fill in the /proc/pidstats record of the thread group of @task.  The
+ * values follow do_task_stat() for the whole group.
+ */
+void proc_pidstats_fill(struct pidstats_record *rec, struct pid_namespace *ns,
+			struct task_struct *task)
+{
+	unsigned long min_flt = 0, maj_flt = 0;
+	u64 utime = 0, stime = 0;
+	struct mm_struct *mm;
+	unsigned long flags;
+
+	memset(rec, 0, sizeof(*rec));
+	rec->size = sizeof(*rec);
+	rec->version = PIDSTATS_VERSION;
+	rec->pid = task_tgid_nr_ns(task, ns);
+	rec->state = *get_task_state(task);
+
+	if (lock_task_sighand(task, &flags)) {
+		struct signal_struct *sig = task->signal;
+		struct task_struct *t = task;
+
+		rec->num_threads = get_nr_threads(task);
+		do {
+			min_flt += t->min_flt;
+			maj_flt += t->maj_flt;
+		} while_each_thread(task, t);
+		min_flt += sig->min_flt;
+		maj_flt += sig->maj_flt;
+		thread_group_cputime_adjusted(task, &utime, &stime);
+		rec->ppid = task_tgid_nr_ns(task->real_parent, ns);
+
+		unlock_task_sighand(task, &flags);
+	}
+
+	rec->nice = task_nice(task);
+	rec->prio = task_prio(task);
+	rec->processor = task_cpu(task);
+	rec->utime_ns = utime;
+	rec->stime_ns = stime;
+	rec->start_time_ns = timens_add_boottime_ns(task->start_boottime);
+	rec->min_flt = min_flt;
+	rec->maj_flt = maj_flt;
+
+	mm = get_task_mm(task);
+	if (mm) {
+		rec->vsize = task_vsize(mm);
+		rec->rss = get_mm_rss(mm);
+		mmput(mm);
+	}
+
+	BUILD_BUG_ON(sizeof(rec->comm) < TASK_COMM_LEN);
+	__get_task_comm(rec->comm, sizeof(rec->comm), task);
+}
+
 int proc_tid_stat(struct seq_file *m, struct pid_namespace *ns,
 			struct pid *pid, struct task_struct *task)
 {
@@ -98,6 +98,7 @@
 #include <linux/resctrl.h>
 #include <linux/cn_proc.h>
 #include <linux/cpufreq_times.h>
+#include <linux/pidstats.h>
 #include <trace/events/oom.h>
 #include "internal.h"
 #include "fd.h"
@@ -3483,6 +3484,71 @@ int proc_pid_readdir(struct file *file, struct dir_context *ctx)
 	return 0;
 }
 
+/*
+ * /proc/pidstats: a binary record per visible thread group, see
+ * include/uapi/linux/pidstats.h.  The seq_file position is the tgid the
+ * next record starts from, so a partial read resumes where it left off.
+ */
+static void *pidstats_next_task(struct seq_file *m, loff_t *pos,
+				struct task_struct *task)
+{
+	struct pid_namespace *ns = proc_pid_ns(file_inode(m->file)->i_sb);
+	struct tgid_iter iter = { .tgid = *pos, .task = task };
+
+	if (*pos >= PID_MAX_LIMIT) {
+		if (task)
+			put_task_struct(task);
+		return NULL;
+	}
+
+	iter = next_tgid(ns, iter);
+	*pos = iter.task ? iter.tgid : PID_MAX_LIMIT;
+	return iter.task;
+}
+
+static void *pidstats_start(struct seq_file *m, loff_t *pos)
+{
+	return pidstats_next_task(m, pos, NULL);
+}
+
+static void *pidstats_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	++*pos;
+	return pidstats_next_task(m, pos, v);
+}
+
+static void pidstats_stop(struct seq_file *m, void *v)
+{
+	if (v)
+		put_task_struct(v);
+}
+
+static int pidstats_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = file_inode(m->file)->i_sb;
+	struct pidstats_record rec;
+
+	cond_resched();
+	if (!has_pid_permissions(proc_sb_info(sb), v, HIDEPID_NO_ACCESS))
+		return SEQ_SKIP;
+
+	proc_pidstats_fill(&rec, proc_pid_ns(sb), v);
+	seq_write(m, &rec, sizeof(rec));
+	return 0;
+}
+
+static const struct seq_operations pidstats_seq_ops = {
+	.start	= pidstats_start,
+	.next	= pidstats_next,
+	.stop	= pidstats_stop,
+	.show	= pidstats_show,
+};
+
+void __init proc_pidstats_init(void)
+{
+	proc_create_seq("pidstats", 0444, NULL, &pidstats_seq_ops);
+}
+
 /*
  * proc_tid_comm_permission is a special permission function exclusively
  * used for the node /proc/<pid>/task/<tid>/comm.
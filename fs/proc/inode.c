@@ -57,6 +57,9 @@ static void proc_evict_inode(struct inode *inode)
 		RCU_INIT_POINTER(ei->sysctl, NULL);
 		proc_sys_evict_inode(inode, head);
 	}
+
+	kfree(ei->smaps_rollup);
+	ei->smaps_rollup = NULL;
 }
 
 static struct kmem_cache *proc_inode_cachep __ro_after_init;
@@ -77,6 +80,7 @@ static struct inode *proc_alloc_inode(struct super_block *sb)
 	ei->sysctl_entry = NULL;
 	INIT_HLIST_NODE(&ei->sibling_inodes);
 	ei->ns_ops = NULL;
+	ei->smaps_rollup = NULL;
 	return &ei->vfs_inode;
 }
 
@@ -99,6 +99,7 @@ struct proc_inode {
 	struct ctl_table *sysctl_entry;
 	struct hlist_node sibling_inodes;
 	const struct proc_ns_operations *ns_ops;
+	struct smaps_rollup_cache *smaps_rollup;
 	struct inode vfs_inode;
 } __randomize_layout;
 
@@ -157,6 +158,9 @@ extern int proc_pid_status(struct seq_file *, struct pid_namespace *,
 			   struct pid *, struct task_struct *);
 extern int proc_pid_statm(struct seq_file *, struct pid_namespace *,
 			  struct pid *, struct task_struct *);
+struct pidstats_record;
+extern void proc_pidstats_fill(struct pidstats_record *,
+			       struct pid_namespace *, struct task_struct *);
 
 /*
  * base.c
@@ -281,6 +285,11 @@ extern struct proc_dir_entry proc_root;
 
 extern void proc_self_init(void);
 
+/*
+ * base.c
+ */
+extern void proc_pidstats_init(void);
+
 /*
  * task_[no]mmu.c
  */
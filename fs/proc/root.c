@@ -291,6 +291,7 @@ void __init proc_root_init(void)
 	set_proc_pid_nlink();
 	proc_self_init();
 	proc_thread_self_init();
+	proc_pidstats_init();
 	proc_symlink("mounts", NULL, "self/mounts");
 
 	proc_net_init();
@@ -20,6 +20,7 @@
 #include <linux/shmem_fs.h>
 #include <linux/uaccess.h>
 #include <linux/pkeys.h>
+#include <linux/moduleparam.h>
 
 #include <asm/elf.h>
 #include <asm/tlb.h>
@@ -865,13 +866,107 @@ static int show_smap(struct seq_file *m, void *v)
 	return 0;
 }
 
+/*
+ * smaps_rollup has to walk every page table of the process, with mmap_lock
+ * held, to compute Pss.  A monitor that polls it for every app at a short
+ * interval spends most of that work recomputing the same answer.  If
+ * smaps_rollup_max_age_ms is set, the result of the last walk is kept with
+ * the proc inode and reused while it is younger than that and the mm's RSS
+ * counters and VMA count haven't changed.  The reused Pss is approximate:
+ * other processes mapping or unmapping shared pages can change it without
+ * touching this mm.  0, the default, always walks and gives exact values.
+ */
+static unsigned int smaps_rollup_max_age_ms;
+module_param(smaps_rollup_max_age_ms, uint, 0644);
+MODULE_PARM_DESC(smaps_rollup_max_age_ms,
+		 "Reuse an unchanged smaps_rollup result for this long (0: always exact)");
+
+struct smaps_rollup_cache {
+	spinlock_t lock;
+	unsigned long stamp;
+	unsigned long counters[NR_MM_COUNTERS];
+	int map_count;
+	unsigned long start;
+	unsigned long end;
+	struct mem_size_stats mss;
+};
+
+static void smaps_rollup_snapshot(struct mm_struct *mm,
+				  unsigned long *counters, int *map_count)
+{
+	int i;
+
+	for (i = 0; i < NR_MM_COUNTERS; i++)
+		counters[i] = get_mm_counter(mm, i);
+	*map_count = READ_ONCE(mm->map_count);
+}
+
+static bool smaps_rollup_cached(struct proc_inode *ei, struct mm_struct *mm,
+				struct mem_size_stats *mss,
+				unsigned long *start, unsigned long *end)
+{
+	struct smaps_rollup_cache *c = READ_ONCE(ei->smaps_rollup);
+	unsigned int max_age = READ_ONCE(smaps_rollup_max_age_ms);
+	unsigned long counters[NR_MM_COUNTERS];
+	int map_count;
+	bool hit;
+
+	if (!max_age || !c)
+		return false;
+
+	smaps_rollup_snapshot(mm, counters, &map_count);
+
+	spin_lock(&c->lock);
+	hit = time_before(jiffies, c->stamp + msecs_to_jiffies(max_age)) &&
+	      c->map_count == map_count &&
+	      !memcmp(c->counters, counters, sizeof(counters));
+	if (hit) {
+		*mss = c->mss;
+		*start = c->start;
+		*end = c->end;
+	}
+	spin_unlock(&c->lock);
+
+	return hit;
+}
+
+static void smaps_rollup_store(struct proc_inode *ei, struct mm_struct *mm,
+			       const struct mem_size_stats *mss,
+			       unsigned long start, unsigned long end)
+{
+	struct smaps_rollup_cache *c = READ_ONCE(ei->smaps_rollup);
+
+	if (!READ_ONCE(smaps_rollup_max_age_ms))
+		return;
+
+	if (!c) {
+		c = kzalloc(sizeof(*c), GFP_KERNEL);
+		if (!c)
+			return;
+		spin_lock_init(&c->lock);
+		if (cmpxchg(&ei->smaps_rollup, NULL, c)) {
+			kfree(c);
+			c = READ_ONCE(ei->smaps_rollup);
+		}
+	}
+
+	spin_lock(&c->lock);
+	/* Changes that raced with the walk are only covered by max_age */
+	smaps_rollup_snapshot(mm, c->counters, &c->map_count);
+	c->stamp = jiffies;
+	c->start = start;
+	c->end = end;
+	c->mss = *mss;
+	spin_unlock(&c->lock);
+}
+
 static int show_smaps_rollup(struct seq_file *m, void *v)
 {
 	struct proc_maps_private *priv = m->private;
 	struct mem_size_stats mss;
 	struct mm_struct *mm;
 	struct vm_area_struct *vma;
-	unsigned long last_vma_end = 0;
+	unsigned long first_vma_start, last_vma_end = 0;
 	int ret = 0;
 
 	priv->task = get_proc_task(priv->inode);
@@ -884,6 +979,17 @@ static int show_smaps_rollup(struct seq_file *m, void *v)
 		goto out_put_task;
 	}
 
+	if (smaps_rollup_cached(PROC_I(priv->inode), mm, &mss,
+				&first_vma_start, &last_vma_end)) {
+		show_vma_header_prefix(m, first_vma_start, last_vma_end,
+				       0, 0, 0, 0);
+		seq_pad(m, ' ');
+		seq_puts(m, "[rollup]\n");
+
+		__show_smap(m, &mss, true);
+		goto out_put_mm;
+	}
+
 	memset(&mss, 0, sizeof(mss));
 
 	ret = mmap_read_lock_killable(mm);
@@ -961,8 +1067,8 @@ static int show_smaps_rollup(struct seq_file *m, void *v)
 		vma = vma->vm_next;
 	}
 
-	show_vma_header_prefix(m, priv->mm->mmap->vm_start,
-			       last_vma_end, 0, 0, 0, 0);
+	first_vma_start = priv->mm->mmap->vm_start;
+	show_vma_header_prefix(m, first_vma_start, last_vma_end, 0, 0, 0, 0);
 	seq_pad(m, ' ');
 	seq_puts(m, "[rollup]\n");
 
@@ -971,6 +1077,9 @@ static int show_smaps_rollup(struct seq_file *m, void *v)
 	release_task_mempolicy(priv);
 	mmap_read_unlock(mm);
 
+	smaps_rollup_store(PROC_I(priv->inode), mm, &mss, first_vma_start,
+			   last_vma_end);
+
 out_put_mm:
 	mmput(mm);
 out_put_task:
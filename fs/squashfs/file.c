@@ -34,11 +34,14 @@
 #include <linux/string.h>
 #include <linux/pagemap.h>
 #include <linux/mutex.h>
+#include <linux/moduleparam.h>
+#include <linux/workqueue.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
 #include "squashfs_fs_i.h"
 #include "squashfs.h"
+#include "page_actor.h"
 
 /*
  * Locate cache slot in range [offset, index] for specified inode.  If
@@ -494,7 +497,231 @@ static int squashfs_readpage(struct file *file, struct page *page)
 	return 0;
 }
 
+#ifdef CONFIG_SQUASHFS_FILE_DIRECT
+/*
+ * Readahead decompresses whole datablocks straight into the page cache.
+ * Up to readahead_blocks consecutive datablocks are set up at a time; the
+ * first is decompressed by the caller and the rest are handed to the unbound
+ * workqueue, so that a sequential read is not limited to a single CPU.  The
+ * number of blocks in flight is also capped by the number of decompressor
+ * streams, as with SQUASHFS_DECOMP_SINGLE extra blocks would only queue on
+ * the single stream.
+ *
+ * Anything that doesn't fit the simple case (partial blocks, sparse blocks,
+ * the fragment-packed tail) is left to squashfs_readpage().
+ */
+static unsigned int squashfs_readahead_blocks = 4;
+module_param_named(readahead_blocks, squashfs_readahead_blocks, uint, 0644);
+MODULE_PARM_DESC(readahead_blocks,
+		 "Datablocks decompressed concurrently by readahead (0 disables readahead)");
+
+static atomic_long_t squashfs_ra_calls;
+static atomic_long_t squashfs_ra_blocks;
+static atomic_long_t squashfs_ra_offloaded;
+static atomic_long_t squashfs_ra_skipped;
+
+static int squashfs_readahead_stats_get(char *buffer,
+					const struct kernel_param *kp)
+{
+	return sprintf(buffer, "calls %ld blocks %ld offloaded %ld skipped %ld\n",
+		       atomic_long_read(&squashfs_ra_calls),
+		       atomic_long_read(&squashfs_ra_blocks),
+		       atomic_long_read(&squashfs_ra_offloaded),
+		       atomic_long_read(&squashfs_ra_skipped));
+}
+
+static const struct kernel_param_ops squashfs_readahead_stats_ops = {
+	.get = squashfs_readahead_stats_get,
+};
+module_param_cb(readahead_stats, &squashfs_readahead_stats_ops, NULL, 0444);
+
+struct squashfs_ra_block {
+	struct work_struct	work;
+	struct super_block	*sb;
+	struct page		**page;
+	int			pages;
+	u64			block;
+	int			bsize;
+	int			expected;
+	int			res;
+};
+
+static void squashfs_ra_decompress(struct squashfs_ra_block *ra)
+{
+	struct squashfs_page_actor *actor;
+	int bytes;
+	void *pageaddr;
+
+	actor = squashfs_page_actor_init_special(ra->page, ra->pages, 0);
+	if (actor == NULL) {
+		ra->res = -ENOMEM;
+		return;
+	}
+
+	ra->res = squashfs_read_data(ra->sb, ra->block, ra->bsize, NULL, actor);
+	kfree(actor);
+
+	if (ra->res >= 0 && ra->res != ra->expected)
+		ra->res = -EIO;
+	if (ra->res < 0)
+		return;
+
+	/* Last page may have trailing bytes not filled */
+	bytes = ra->res % PAGE_SIZE;
+	if (bytes) {
+		pageaddr = kmap_atomic(ra->page[ra->pages - 1]);
+		memset(pageaddr + bytes, 0, PAGE_SIZE - bytes);
+		kunmap_atomic(pageaddr);
+	}
+}
+
+static void squashfs_ra_work(struct work_struct *work)
+{
+	squashfs_ra_decompress(container_of(work, struct squashfs_ra_block,
+					    work));
+}
+
+/*
+ * Take the next datablock worth of pages off the readahead request and
+ * look up where the block lives.  Returns 1 if @ra is ready to be
+ * decompressed, 0 if the request is exhausted and -EAGAIN if the pages
+ * were handed back for squashfs_readpage() to deal with.
+ */
+static int squashfs_ra_prepare(struct readahead_control *ractl,
+			       struct squashfs_ra_block *ra)
+{
+	struct inode *inode = ractl->mapping->host;
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+	int shift = msblk->block_log - PAGE_SHIFT;
+	int max_pages = 1 << shift;
+	loff_t i_size = i_size_read(inode);
+	int file_end = i_size >> msblk->block_log;
+	int index, want, i;
+
+	ra->pages = __readahead_batch(ractl, ra->page, max_pages);
+	if (!ra->pages)
+		return 0;
+
+	if (readahead_pos(ractl) >= i_size)
+		goto skip_pages;
+
+	index = ra->page[0]->index >> shift;
+	if (ra->page[0]->index & (max_pages - 1))
+		goto skip_pages;
+
+	want = min_t(int, max_pages, ((i_size - 1) >> PAGE_SHIFT) -
+				     ra->page[0]->index + 1);
+	if (ra->pages != want)
+		goto skip_pages;
+
+	if (index == file_end && squashfs_i(inode)->fragment_block !=
+					SQUASHFS_INVALID_BLK)
+		goto skip_pages;
+
+	ra->expected = index == file_end ?
+			(i_size & (msblk->block_size - 1)) : msblk->block_size;
+	ra->bsize = read_blocklist(inode, index, &ra->block);
+	if (ra->bsize <= 0)
+		goto skip_pages;
+
+	ra->sb = inode->i_sb;
+	return 1;
+
+skip_pages:
+	for (i = 0; i < ra->pages; i++) {
+		unlock_page(ra->page[i]);
+		put_page(ra->page[i]);
+	}
+	atomic_long_inc(&squashfs_ra_skipped);
+	return -EAGAIN;
+}
+
+static void squashfs_ra_finish(struct squashfs_ra_block *ra)
+{
+	int i;
+
+	for (i = 0; i < ra->pages; i++) {
+		if (ra->res < 0) {
+			SetPageError(ra->page[i]);
+		} else {
+			flush_dcache_page(ra->page[i]);
+			SetPageUptodate(ra->page[i]);
+		}
+		unlock_page(ra->page[i]);
+		put_page(ra->page[i]);
+	}
+}
+
+static void squashfs_readahead(struct readahead_control *ractl)
+{
+	struct inode *inode = ractl->mapping->host;
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+	size_t mask = (1UL << msblk->block_log) - 1;
+	int max_pages = 1 << (msblk->block_log - PAGE_SHIFT);
+	loff_t start = readahead_pos(ractl) & ~mask;
+	size_t len = readahead_length(ractl) + readahead_pos(ractl) - start;
+	struct squashfs_ra_block *ra;
+	int nr_blocks, i, n, res;
+
+	nr_blocks = min3(READ_ONCE(squashfs_readahead_blocks),
+			 (unsigned int)squashfs_max_decompressors(),
+			 num_online_cpus());
+	if (!nr_blocks)
+		return;
+
+	ra = kcalloc(nr_blocks, sizeof(*ra), GFP_KERNEL);
+	if (ra == NULL)
+		return;
+
+	for (i = 0; i < nr_blocks; i++) {
+		ra[i].page = kmalloc_array(max_pages, sizeof(void *),
+					   GFP_KERNEL);
+		if (ra[i].page == NULL)
+			goto out;
+		INIT_WORK(&ra[i].work, squashfs_ra_work);
+	}
+
+	readahead_expand(ractl, start, (len | mask) + 1);
+	atomic_long_inc(&squashfs_ra_calls);
+
+	do {
+		for (n = 0; n < nr_blocks; ) {
+			res = squashfs_ra_prepare(ractl, &ra[n]);
+			if (res == 0)
+				break;
+			if (res > 0)
+				n++;
+		}
+
+		for (i = 1; i < n; i++)
+			queue_work(system_unbound_wq, &ra[i].work);
+		if (n)
+			squashfs_ra_decompress(&ra[0]);
+
+		for (i = 0; i < n; i++) {
+			if (i)
+				flush_work(&ra[i].work);
+			if (ra[i].res < 0)
+				ERROR("Unable to read page, block %llx, size %x\n",
+				      ra[i].block, ra[i].bsize);
+			squashfs_ra_finish(&ra[i]);
+		}
+
+		atomic_long_add(n, &squashfs_ra_blocks);
+		if (n > 1)
+			atomic_long_add(n - 1, &squashfs_ra_offloaded);
+	} while (n == nr_blocks);
+
+out:
+	for (i = 0; i < nr_blocks; i++)
+		kfree(ra[i].page);
+	kfree(ra);
+}
+#endif
 
 const struct address_space_operations squashfs_aops = {
-	.readpage = squashfs_readpage
+	.readpage = squashfs_readpage,
+#ifdef CONFIG_SQUASHFS_FILE_DIRECT
+	.readahead = squashfs_readahead,
+#endif
 };
@@ -69,12 +69,19 @@ struct merkle_tree_params {
  * caches information about the Merkle tree that's needed to efficiently verify
  * data read from the file.  It also caches the file digest.  The Merkle tree
  * pages themselves are not cached here, but the filesystem may cache them.
+ *
+ * The digests of Merkle tree blocks that have been verified are remembered
+ * too, if memory allows.  That way a tree page that got evicted and read back
+ * only needs to be hashed and compared against its remembered digest, rather
+ * than having the whole path up to the root read and verified again.
  */
 struct fsverity_info {
 	struct merkle_tree_params tree_params;
 	u8 root_hash[FS_VERITY_MAX_DIGEST_SIZE];
 	u8 file_digest[FS_VERITY_MAX_DIGEST_SIZE];
 	const struct inode *inode;
+	u8 *hash_block_digests;
+	unsigned long *hash_block_verified;
 };
 
 /* Arbitrary limit to bound the kmalloc() size.  Can be changed. */
@@ -8,6 +8,7 @@
 #include "fsverity_private.h"
 
 #include <linux/slab.h>
+#include <linux/mm.h>
 
 static struct kmem_cache *fsverity_info_cachep;
 
@@ -141,6 +142,31 @@ static int compute_file_digest(struct fsverity_hash_alg *hash_alg,
 	return err;
 }
 
+/*
+ * Allocate the cache of verified Merkle tree block digests.  This is only an
+ * optimization, so it's fine to go without it if the allocation fails.
+ */
+static void alloc_hash_block_cache(struct fsverity_info *vi)
+{
+	const struct merkle_tree_params *params = &vi->tree_params;
+	unsigned long num_blocks = params->tree_size >> params->log_blocksize;
+
+	if (!num_blocks)
+		return;
+
+	vi->hash_block_digests = kvcalloc(num_blocks, params->digest_size,
+					  GFP_KERNEL | __GFP_NOWARN);
+	vi->hash_block_verified = kvcalloc(BITS_TO_LONGS(num_blocks),
+					   sizeof(unsigned long),
+					   GFP_KERNEL | __GFP_NOWARN);
+	if (!vi->hash_block_digests || !vi->hash_block_verified) {
+		kvfree(vi->hash_block_digests);
+		kvfree(vi->hash_block_verified);
+		vi->hash_block_digests = NULL;
+		vi->hash_block_verified = NULL;
+	}
+}
+
 /*
  * Create a new fsverity_info from the given fsverity_descriptor (with optional
  * appended signature), and check the signature if present.  The
@@ -171,6 +197,8 @@ struct fsverity_info *fsverity_create_info(const struct inode *inode,
 
 	memcpy(vi->root_hash, desc->root_hash, vi->tree_params.digest_size);
 
+	alloc_hash_block_cache(vi);
+
 	err = compute_file_digest(vi->tree_params.hash_alg, desc,
 				  vi->file_digest);
 	if (err) {
@@ -215,6 +243,8 @@ void fsverity_free_info(struct fsverity_info *vi)
 	if (!vi)
 		return;
 	kfree(vi->tree_params.hashstate);
+	kvfree(vi->hash_block_digests);
+	kvfree(vi->hash_block_verified);
 	kmem_cache_free(fsverity_info_cachep, vi);
 }
 
@@ -49,6 +49,31 @@ static void extract_hash(struct page *hpage, unsigned int hoffset,
 	kunmap_atomic(virt);
 }
 
+/* Return the remembered digest of a verified hash block, or NULL */
+static const u8 *cached_hash_block_digest(const struct fsverity_info *vi,
+					  pgoff_t hindex)
+{
+	if (!vi->hash_block_verified ||
+	    !test_bit(hindex, vi->hash_block_verified))
+		return NULL;
+	/* Pairs with the smp_wmb() in cache_hash_block_digest() */
+	smp_rmb();
+	return vi->hash_block_digests + hindex * vi->tree_params.digest_size;
+}
+
+/* Remember the digest of a hash block that has just been verified */
+static void cache_hash_block_digest(const struct fsverity_info *vi,
+				    pgoff_t hindex, const u8 *digest)
+{
+	if (!vi->hash_block_verified ||
+	    test_bit(hindex, vi->hash_block_verified))
+		return;
+	memcpy(vi->hash_block_digests + hindex * vi->tree_params.digest_size,
+	       digest, vi->tree_params.digest_size);
+	smp_wmb();
+	set_bit(hindex, vi->hash_block_verified);
+}
+
 static inline int cmp_hashes(const struct fsverity_info *vi,
 			     const u8 *want_hash, const u8 *real_hash,
 			     pgoff_t index, int level)
@@ -72,7 +97,10 @@ static inline int cmp_hashes(const struct fsverity_info *vi,
  * In principle, we need to verify the entire path to the root node.  However,
  * for efficiency the filesystem may cache the hash pages.  Therefore we need
  * only ascend the tree until an already-verified page is seen, as indicated by
- * the PageChecked bit being set; then verify the path to that page.
+ * the PageChecked bit being set; then verify the path to that page.  A hash
+ * page that was verified before but has been evicted since doesn't have
+ * PageChecked set; if its digest was remembered, it's enough to check it
+ * against that digest instead of continuing towards the root.
  *
  * This code currently only supports the case where the verity block size is
  * equal to PAGE_SIZE.  Doing otherwise would be possible but tricky, since we
@@ -96,6 +124,8 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 	u8 real_hash[FS_VERITY_MAX_DIGEST_SIZE];
 	struct page *hpages[FS_VERITY_MAX_LEVELS];
 	unsigned int hoffsets[FS_VERITY_MAX_LEVELS];
+	pgoff_t hindices[FS_VERITY_MAX_LEVELS];
+	const u8 *cached_hash;
 	int err;
 
 	if (WARN_ON_ONCE(!PageLocked(data_page) || PageUptodate(data_page)))
@@ -140,6 +170,18 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 		pr_debug_ratelimited("Hash page not yet checked\n");
 		hpages[level] = hpage;
 		hoffsets[level] = hoffset;
+		hindices[level] = hindex;
+
+		cached_hash = cached_hash_block_digest(vi, hindex);
+		if (cached_hash) {
+			memcpy(_want_hash, cached_hash, hsize);
+			want_hash = _want_hash;
+			level++;
+			pr_debug_ratelimited("Hash page verified before, want %s:%*phN\n",
+					     params->hash_alg->name,
+					     hsize, want_hash);
+			goto descend;
+		}
 	}
 
 	want_hash = vi->root_hash;
@@ -157,6 +199,7 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 		err = cmp_hashes(vi, want_hash, real_hash, index, level - 1);
 		if (err)
 			goto out;
+		cache_hash_block_digest(vi, hindices[level - 1], real_hash);
 		SetPageChecked(hpage);
 		extract_hash(hpage, hoffset, hsize, _want_hash);
 		want_hash = _want_hash;
@@ -232,6 +232,11 @@ struct fsnotify_group {
 		struct fanotify_group_private_data {
 			/* Hash table of events for merge */
 			struct hlist_head *merge_hash;
+			unsigned int merge_hash_bits;
+			/* queue statistics, shown in fdinfo */
+			unsigned long nr_hashed;	/* under notification_lock */
+			unsigned long nr_merged;	/* under notification_lock */
+			atomic_long_t nr_overflows;
 			/* allows a group to block waiting for a userspace response */
 			struct list_head access_list;
 			wait_queue_head_t access_waitq;
@@ -72,6 +72,7 @@ static inline void __mmap_lock_trace_released(struct mm_struct *mm, bool write)
 static inline void mmap_init_lock(struct mm_struct *mm)
 {
 	init_rwsem(&mm->mmap_lock);
+	rwsem_set_reader_spin(&mm->mmap_lock);
 #ifdef CONFIG_SPECULATIVE_PAGE_FAULT
 	mm->mmap_seq = 0;
 #endif
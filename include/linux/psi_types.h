@@ -120,6 +120,9 @@ struct psi_trigger {
 	/* User-spacified threshold in ns */
 	u64 threshold;
 
+	/* Max delay between crossing the threshold and the event in ns */
+	u64 latency;
+
 	/* List node inside triggers list */
 	struct list_head node;
 
@@ -140,6 +143,12 @@ struct psi_trigger {
 	 * events to one per window
 	 */
 	u64 last_event_time;
+
+	/* Window growth that generated the last event in ns */
+	u64 last_event_growth;
+
+	/* Next trigger sharing the same file descriptor */
+	struct psi_trigger *next;
 };
 
 struct psi_group {
@@ -167,6 +176,13 @@ struct psi_group {
 	wait_queue_head_t poll_wait;
 	atomic_t poll_wakeup;
 
+	/*
+	 * Stall time accounting on/off, see cgroup.pressure. Kept in the
+	 * padding after poll_wakeup so that struct psi_group, which is
+	 * embedded in struct cgroup, keeps its size and layout.
+	 */
+	bool enabled;
+
 	/* Protects data used by the monitor */
 	struct mutex trigger_lock;
 
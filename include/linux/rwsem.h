@@ -83,10 +83,19 @@ struct rwsem_waiter {
 	bool handoff_set;
 };
 
-/* In all implementations count != 0 means locked */
+/*
+ * Spare count bit set by rwsem_set_reader_spin(). It is a property of the
+ * lock rather than part of its state, and is ignored by all lock checks.
+ */
+#define RWSEM_FLAG_READER_SPIN		(1UL << 3)
+
+/*
+ * In all implementations count != 0 means locked, RWSEM_FLAG_READER_SPIN
+ * aside
+ */
 static inline int rwsem_is_locked(struct rw_semaphore *sem)
 {
-	return atomic_long_read(&sem->count) != 0;
+	return (atomic_long_read(&sem->count) & ~RWSEM_FLAG_READER_SPIN) != 0;
 }
 
 #define RWSEM_UNLOCKED_VALUE		0L
@@ -139,6 +148,20 @@ static inline int rwsem_is_contended(struct rw_semaphore *sem)
 	return !list_empty(&sem->wait_list);
 }
 
+/*
+ * Let readers optimistically spin for a bounded time on a running writer
+ * instead of going to sleep. Meant for locks like mmap_lock that are
+ * mostly read and only briefly write locked.
+ */
+#ifdef CONFIG_RWSEM_SPIN_ON_OWNER
+static inline void rwsem_set_reader_spin(struct rw_semaphore *sem)
+{
+	atomic_long_or(RWSEM_FLAG_READER_SPIN, &sem->count);
+}
+#else
+static inline void rwsem_set_reader_spin(struct rw_semaphore *sem) { }
+#endif
+
 #else /* !CONFIG_PREEMPT_RT */
 
 #include <linux/rwbase_rt.h>
@@ -179,6 +202,8 @@ static __always_inline int rwsem_is_contended(struct rw_semaphore *sem)
 	return rw_base_is_contended(&sem->rwbase);
 }
 
+static inline void rwsem_set_reader_spin(struct rw_semaphore *sem) { }
+
 #endif /* CONFIG_PREEMPT_RT */
 
 /*
@@ -1876,6 +1876,7 @@ static inline int dl_task_check_affinity(struct task_struct *p, const struct cpu
 #endif
 
 extern int yield_to(struct task_struct *p, bool preempt);
+extern bool sched_lock_owner_boost(struct task_struct *owner);
 extern void set_user_nice(struct task_struct *p, long nice);
 extern int task_prio(const struct task_struct *p);
 
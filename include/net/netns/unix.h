@@ -8,6 +8,7 @@
 struct ctl_table_header;
 struct netns_unix {
 	int			sysctl_max_dgram_qlen;
+	unsigned int		sysctl_dgram_wake_batch;
 	struct ctl_table_header	*ctl;
 };
 
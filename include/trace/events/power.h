@@ -8,6 +8,7 @@
 #include <linux/cpufreq.h>
 #include <linux/ktime.h>
 #include <linux/pm_qos.h>
+#include <linux/sched.h>
 #include <linux/tracepoint.h>
 #include <linux/trace_events.h>
 
@@ -245,6 +246,32 @@ TRACE_EVENT(suspend_resume,
 		(__entry->start)?"begin":"end")
 );
 
+/*
+ * Tracepoint for a task that was slow to enter the refrigerator, i.e. did
+ * not freeze on the first pass of try_to_freeze_tasks():
+ */
+TRACE_EVENT(freeze_task_latency,
+
+	TP_PROTO(struct task_struct *p, unsigned int msecs),
+
+	TP_ARGS(p, msecs),
+
+	TP_STRUCT__entry(
+		__array(char, comm, TASK_COMM_LEN)
+		__field(pid_t, pid)
+		__field(unsigned int, msecs)
+	),
+
+	TP_fast_assign(
+		memcpy(__entry->comm, p->comm, TASK_COMM_LEN);
+		__entry->pid = p->pid;
+		__entry->msecs = msecs;
+	),
+
+	TP_printk("comm=%s pid=%d msecs=%u",
+		__entry->comm, __entry->pid, __entry->msecs)
+);
+
 DECLARE_EVENT_CLASS(wakeup_source,
 
 	TP_PROTO(const char *name, unsigned int state),
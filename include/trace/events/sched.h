@@ -574,6 +574,36 @@ TRACE_EVENT(sched_pi_setprio,
 			__entry->oldprio, __entry->newprio)
 );
 
+/*
+ * Tracepoint for a lock waiter handing its turn to the lock owner:
+ */
+TRACE_EVENT(sched_lock_owner_boost,
+
+	TP_PROTO(struct task_struct *owner, struct task_struct *waiter),
+
+	TP_ARGS(owner, waiter),
+
+	TP_STRUCT__entry(
+		__array( char,	comm,	TASK_COMM_LEN	)
+		__field( pid_t,	pid			)
+		__field( int,	prio			)
+		__field( pid_t,	waiter_pid		)
+		__field( int,	waiter_prio		)
+	),
+
+	TP_fast_assign(
+		memcpy(__entry->comm, owner->comm, TASK_COMM_LEN);
+		__entry->pid		= owner->pid;
+		__entry->prio		= owner->prio;
+		__entry->waiter_pid	= waiter->pid;
+		__entry->waiter_prio	= waiter->prio;
+	),
+
+	TP_printk("comm=%s pid=%d prio=%d waiter_pid=%d waiter_prio=%d",
+			__entry->comm, __entry->pid, __entry->prio,
+			__entry->waiter_pid, __entry->waiter_prio)
+);
+
 #ifdef CONFIG_DETECT_HUNG_TASK
 TRACE_EVENT(sched_process_hang,
 	TP_PROTO(struct task_struct *tsk),
@@ -472,6 +472,11 @@ DECLARE_RESTRICTED_HOOK(android_rvh_update_rt_rq_load_avg,
 DECLARE_HOOK(android_vh_mmput,
 	TP_PROTO(struct mm_struct *mm),
 	TP_ARGS(mm));
+
+DECLARE_HOOK(android_vh_lock_owner_boost,
+	TP_PROTO(struct task_struct *owner, struct task_struct *waiter,
+		 bool *boosted),
+	TP_ARGS(owner, waiter, boosted));
 /* macro versions of hooks are no longer required */
 
 #endif /* _TRACE_HOOK_SCHED_H */
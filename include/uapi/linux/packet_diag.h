@@ -19,6 +19,7 @@ struct packet_diag_req {
 #define PACKET_SHOW_FANOUT	0x00000008
 #define PACKET_SHOW_MEMINFO	0x00000010
 #define PACKET_SHOW_FILTER	0x00000020
+#define PACKET_SHOW_RX_STATS	0x00000040
 
 struct packet_diag_msg {
 	__u8	pdiag_family;
@@ -39,6 +40,7 @@ enum {
 	PACKET_DIAG_UID,
 	PACKET_DIAG_MEMINFO,
 	PACKET_DIAG_FILTER,
+	PACKET_DIAG_RX_STATS,
 
 	__PACKET_DIAG_MAX,
 };
@@ -78,4 +80,10 @@ struct packet_diag_ring {
 	__u32	pdr_features;
 };
 
+struct packet_diag_rx_stats {
+	__u64	pdrs_ring_full;		/* no free frame/block in rx ring */
+	__u64	pdrs_rcvbuf_full;	/* sk_rcvbuf exhausted */
+	__u64	pdrs_contended;		/* receive queue lock was busy */
+};
+
 #endif
@@ -0,0 +1,41 @@
+/* SPDX-License-Identifier: GPL-2.0 WITH Linux-syscall-note */
+#ifndef _UAPI_LINUX_PIDSTATS_H
+#define _UAPI_LINUX_PIDSTATS_H
+
+#include <linux/types.h>
+
+/*
+ * /proc/pidstats returns one struct pidstats_record per thread group that
+ * is visible in /proc, back to back, in ascending pid order.  The values
+ * are the same as the corresponding /proc/<pid>/stat fields, but in
+ * fixed-width binary form so that a monitor can sample every process with
+ * a single open and a few reads.
+ *
+ * Fields are only ever appended.  Readers must step from one record to
+ * the next using @size and must ignore trailing bytes they don't know about.
+ */
+#define PIDSTATS_VERSION	1
+#define PIDSTATS_COMM_LEN	16
+
+struct pidstats_record {
+	__u16	size;		/* size of this record in bytes */
+	__u16	version;	/* PIDSTATS_VERSION */
+	__s32	pid;		/* thread group id, in the reader's pid ns */
+	__s32	ppid;
+	__s32	num_threads;
+	__u8	state;		/* state letter, as in /proc/<pid>/stat */
+	__u8	__pad[3];
+	__s32	nice;
+	__s32	prio;
+	__s32	processor;	/* CPU the group leader last ran on */
+	__u64	utime_ns;	/* user time of all threads */
+	__u64	stime_ns;	/* system time of all threads */
+	__u64	start_time_ns;	/* since boot */
+	__u64	min_flt;
+	__u64	maj_flt;
+	__u64	vsize;		/* bytes */
+	__u64	rss;		/* pages */
+	char	comm[PIDSTATS_COMM_LEN];
+};
+
+#endif /* _UAPI_LINUX_PIDSTATS_H */
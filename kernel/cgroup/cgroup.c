@@ -3667,35 +3667,40 @@ static int cpu_stat_show(struct seq_file *seq, void *v)
 }
 
 #ifdef CONFIG_PSI
-static int cgroup_io_pressure_show(struct seq_file *seq, void *v)
+static int cgroup_pressure_show(struct seq_file *seq, enum psi_res res)
 {
+	struct kernfs_open_file *of = seq->private;
+	struct cgroup_file_ctx *ctx = of->priv;
 	struct cgroup *cgrp = seq_css(seq)->cgroup;
 	struct psi_group *psi = cgroup_ino(cgrp) == 1 ? &psi_system : &cgrp->psi;
+	int ret;
 
-	return psi_show(seq, psi, PSI_IO);
+	ret = psi_show(seq, psi, res);
+	if (!ret)
+		psi_trigger_show(seq, smp_load_acquire(&ctx->psi.trigger));
+
+	return ret;
+}
+static int cgroup_io_pressure_show(struct seq_file *seq, void *v)
+{
+	return cgroup_pressure_show(seq, PSI_IO);
 }
 static int cgroup_memory_pressure_show(struct seq_file *seq, void *v)
 {
-	struct cgroup *cgrp = seq_css(seq)->cgroup;
-	struct psi_group *psi = cgroup_ino(cgrp) == 1 ? &psi_system : &cgrp->psi;
-
-	return psi_show(seq, psi, PSI_MEM);
+	return cgroup_pressure_show(seq, PSI_MEM);
 }
 static int cgroup_cpu_pressure_show(struct seq_file *seq, void *v)
 {
-	struct cgroup *cgrp = seq_css(seq)->cgroup;
-	struct psi_group *psi = cgroup_ino(cgrp) == 1 ? &psi_system : &cgrp->psi;
-
-	return psi_show(seq, psi, PSI_CPU);
+	return cgroup_pressure_show(seq, PSI_CPU);
 }
 
 static ssize_t cgroup_pressure_write(struct kernfs_open_file *of, char *buf,
 					  size_t nbytes, enum psi_res res)
 {
 	struct cgroup_file_ctx *ctx = of->priv;
-	struct psi_trigger *new;
 	struct cgroup *cgrp;
 	struct psi_group *psi;
+	int ret;
 
 	cgrp = cgroup_kn_lock_live(of->kn, false);
 	if (!cgrp)
@@ -3704,23 +3709,12 @@ static ssize_t cgroup_pressure_write(struct kernfs_open_file *of, char *buf,
 	cgroup_get(cgrp);
 	cgroup_kn_unlock(of->kn);
 
-	/* Allow only one trigger per file descriptor */
-	if (ctx->psi.trigger) {
-		cgroup_put(cgrp);
-		return -EBUSY;
-	}
-
+	/* Writers are serialized by of->mutex */
 	psi = cgroup_ino(cgrp) == 1 ? &psi_system : &cgrp->psi;
-	new = psi_trigger_create(psi, buf, nbytes, res);
-	if (IS_ERR(new)) {
-		cgroup_put(cgrp);
-		return PTR_ERR(new);
-	}
-
-	smp_store_release(&ctx->psi.trigger, new);
+	ret = psi_trigger_add(&ctx->psi.trigger, psi, buf, nbytes, res);
 	cgroup_put(cgrp);
 
-	return nbytes;
+	return ret ? ret : nbytes;
 }
 
 static ssize_t cgroup_io_pressure_write(struct kernfs_open_file *of,
@@ -3744,6 +3738,44 @@ static ssize_t cgroup_cpu_pressure_write(struct kernfs_open_file *of,
 	return cgroup_pressure_write(of, buf, nbytes, PSI_CPU);
 }
 
+static int cgroup_pressure_enable_show(struct seq_file *seq, void *v)
+{
+	struct cgroup *cgrp = seq_css(seq)->cgroup;
+
+	seq_printf(seq, "%d\n", cgrp->psi.enabled);
+
+	return 0;
+}
+
+static ssize_t cgroup_pressure_enable_write(struct kernfs_open_file *of,
+					    char *buf, size_t nbytes,
+					    loff_t off)
+{
+	struct cgroup *cgrp;
+	int enable;
+	int ret;
+
+	ret = kstrtoint(strstrip(buf), 0, &enable);
+	if (ret)
+		return ret;
+
+	if (enable < 0 || enable > 1)
+		return -ERANGE;
+
+	cgrp = cgroup_kn_lock_live(of->kn, false);
+	if (!cgrp)
+		return -ENOENT;
+
+	if (cgrp->psi.enabled != enable) {
+		cgrp->psi.enabled = enable;
+		psi_cgroup_restart(&cgrp->psi);
+	}
+
+	cgroup_kn_unlock(of->kn);
+
+	return nbytes;
+}
+
 static __poll_t cgroup_pressure_poll(struct kernfs_open_file *of,
 					  poll_table *pt)
 {
@@ -5115,6 +5147,12 @@ static struct cftype cgroup_base_files[] = {
 		.seq_show = cpu_stat_show,
 	},
 #ifdef CONFIG_PSI
+	{
+		.name = "cgroup.pressure",
+		.flags = CFTYPE_PRESSURE | CFTYPE_NOT_ON_ROOT,
+		.seq_show = cgroup_pressure_enable_show,
+		.write = cgroup_pressure_enable_write,
+	},
 	{
 		.name = "io.pressure",
 		.flags = CFTYPE_PRESSURE,
@@ -67,3 +67,13 @@ LOCK_EVENT(rwsem_rlock_handoff)	/* # of read lock handoffs		*/
 LOCK_EVENT(rwsem_wlock)		/* # of write locks acquired		*/
 LOCK_EVENT(rwsem_wlock_fail)	/* # of failed write lock acquisitions	*/
 LOCK_EVENT(rwsem_wlock_handoff)	/* # of write lock handoffs		*/
+LOCK_EVENT(rwsem_rspin_lock)	/* # of opt-acquired read locks		*/
+LOCK_EVENT(rwsem_rspin_fail)	/* # of failed reader optspins		*/
+LOCK_EVENT(rwsem_rwait_100us)	/* # of reader sleeps < 100us		*/
+LOCK_EVENT(rwsem_rwait_1ms)	/* # of reader sleeps < 1ms		*/
+LOCK_EVENT(rwsem_rwait_10ms)	/* # of reader sleeps < 10ms		*/
+LOCK_EVENT(rwsem_rwait_long)	/* # of reader sleeps >= 10ms		*/
+LOCK_EVENT(rwsem_wwait_100us)	/* # of writer sleeps < 100us		*/
+LOCK_EVENT(rwsem_wwait_1ms)	/* # of writer sleeps < 1ms		*/
+LOCK_EVENT(rwsem_wwait_10ms)	/* # of writer sleeps < 10ms		*/
+LOCK_EVENT(rwsem_wwait_long)	/* # of writer sleeps >= 10ms		*/
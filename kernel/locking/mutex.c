@@ -564,6 +564,21 @@ void __sched ww_mutex_unlock(struct ww_mutex *lock)
 }
 EXPORT_SYMBOL(ww_mutex_unlock);
 
+/*
+ * Before going to sleep, ask the scheduler to run a preempted owner of
+ * lower priority next, see sched_lock_owner_boost().
+ */
+static void mutex_boost_owner(struct mutex *lock)
+{
+	struct task_struct *owner;
+
+	rcu_read_lock();
+	owner = __mutex_owner(lock);
+	if (owner && owner != current)
+		sched_lock_owner_boost(owner);
+	rcu_read_unlock();
+}
+
 /*
  * Lock a mutex (possibly interruptible), slowpath:
  */
@@ -677,6 +692,7 @@ __mutex_lock_common(struct mutex *lock, unsigned int state, unsigned int subclas
 		}
 
 		raw_spin_unlock(&lock->wait_lock);
+		mutex_boost_owner(lock);
 		schedule_preempt_disabled();
 
 		first = __mutex_waiter_is_first(lock, &waiter);
@@ -25,6 +25,7 @@
 #include <linux/sched/signal.h>
 #include <linux/sched/clock.h>
 #include <linux/export.h>
+#include <linux/init.h>
 #include <linux/rwsem.h>
 #include <linux/atomic.h>
 
@@ -86,7 +87,8 @@
  * Bit  0    - writer locked bit
  * Bit  1    - waiters present bit
  * Bit  2    - lock handoff bit
- * Bits 3-7  - reserved
+ * Bit  3    - reader spin opt-in bit
+ * Bits 4-7  - reserved
  * Bits 8-62 - 55-bit reader count
  * Bit  63   - read fail bit
  *
@@ -95,7 +97,8 @@
  * Bit  0    - writer locked bit
  * Bit  1    - waiters present bit
  * Bit  2    - lock handoff bit
- * Bits 3-7  - reserved
+ * Bit  3    - reader spin opt-in bit
+ * Bits 4-7  - reserved
  * Bits 8-30 - 23-bit reader count
  * Bit  31   - read fail bit
  *
@@ -119,6 +122,7 @@
 #define RWSEM_WRITER_LOCKED	(1UL << 0)
 #define RWSEM_FLAG_WAITERS	(1UL << 1)
 #define RWSEM_FLAG_HANDOFF	(1UL << 2)
+/* RWSEM_FLAG_READER_SPIN	(1UL << 3), see <linux/rwsem.h> */
 #define RWSEM_FLAG_READFAIL	(1UL << (BITS_PER_LONG - 1))
 
 #define RWSEM_READER_SHIFT	8
@@ -257,15 +261,26 @@ static inline bool rwsem_read_trylock(struct rw_semaphore *sem, long *cntp)
 
 static inline bool rwsem_write_trylock(struct rw_semaphore *sem)
 {
-	long tmp = RWSEM_UNLOCKED_VALUE;
+	long tmp;
 	bool ret = false;
 
+	/*
+	 * Expect the lock to be free, keeping the RWSEM_FLAG_READER_SPIN bit
+	 * of locks that opted in so that the first cmpxchg succeeds on them.
+	 */
+	tmp = RWSEM_UNLOCKED_VALUE |
+	      (atomic_long_read(&sem->count) & RWSEM_FLAG_READER_SPIN);
+
 	preempt_disable();
-	if (atomic_long_try_cmpxchg_acquire(&sem->count, &tmp, RWSEM_WRITER_LOCKED)) {
-		trace_android_vh_record_rwsem_lock_starttime(current, jiffies);
-		rwsem_set_owner(sem);
-		ret = true;
-	}
+	do {
+		if (atomic_long_try_cmpxchg_acquire(&sem->count, &tmp,
+					tmp | RWSEM_WRITER_LOCKED)) {
+			trace_android_vh_record_rwsem_lock_starttime(current, jiffies);
+			rwsem_set_owner(sem);
+			ret = true;
+			break;
+		}
+	} while (!(tmp & ~RWSEM_FLAG_READER_SPIN));
 
 	preempt_enable();
 	return ret;
@@ -353,6 +368,36 @@ enum rwsem_wake_type {
  */
 #define RWSEM_WAIT_TIMEOUT	DIV_ROUND_UP(HZ, 250)
 
+#ifdef CONFIG_LOCK_EVENT_COUNTS
+static inline u64 rwsem_wait_start(void)
+{
+	return sched_clock();
+}
+
+/*
+ * Account the time spent sleeping in the slowpath into one of four
+ * buckets: below 100us, 1ms, 10ms and anything longer.
+ */
+static inline void __rwsem_wait_done(enum lock_events first, u64 start)
+{
+	u64 delta = sched_clock() - start;
+	int bucket = 0;
+
+	while (bucket < 3 && delta >= 100 * NSEC_PER_USEC) {
+		delta = div_u64(delta, 10);
+		bucket++;
+	}
+	__lockevent_inc(first + bucket, true);
+}
+#define rwsem_wait_done(ev, start) __rwsem_wait_done(LOCKEVENT_ ##ev, start)
+#else
+static inline u64 rwsem_wait_start(void)
+{
+	return 0;
+}
+#define rwsem_wait_done(ev, start)	((void)(start))
+#endif
+
 /*
  * Magic number to batch-wakeup waiting readers, even when writers are
  * also present in the queue. This both limits the amount of work the
@@ -910,6 +955,103 @@ static bool rwsem_optimistic_spin(struct rw_semaphore *sem)
 	return taken;
 }
 
+/*
+ * Upper bound on the time a reader spins on a write-locked rwsem that
+ * opted in with rwsem_set_reader_spin(), 0 disables reader spinning.
+ */
+static unsigned int rwsem_reader_spin_ns __read_mostly = 20 * NSEC_PER_USEC;
+
+static int __init rwsem_reader_spin_setup(char *str)
+{
+	unsigned int us;
+
+	if (kstrtouint(str, 0, &us))
+		return 0;
+	rwsem_reader_spin_ns = min(us, 1000U) * NSEC_PER_USEC;
+	return 1;
+}
+__setup("rwsem_reader_spin_us=", rwsem_reader_spin_setup);
+
+/*
+ * Try to acquire read lock before the reader has been put on wait queue.
+ * The caller must have backed out its own RWSEM_READER_BIAS.
+ */
+static inline bool rwsem_try_read_lock_unqueued(struct rw_semaphore *sem)
+{
+	long count = atomic_long_read(&sem->count);
+
+	if (count & (RWSEM_WRITER_MASK | RWSEM_FLAG_HANDOFF))
+		return false;
+
+	count = atomic_long_fetch_add_acquire(RWSEM_READER_BIAS, &sem->count);
+	if (!(count & (RWSEM_WRITER_MASK | RWSEM_FLAG_HANDOFF))) {
+		rwsem_set_reader_owned(sem);
+		lockevent_inc(rwsem_rspin_lock);
+		return true;
+	}
+
+	/* Back out the change */
+	atomic_long_add(-RWSEM_READER_BIAS, &sem->count);
+	return false;
+}
+
+static inline bool rwsem_can_reader_spin(long count)
+{
+	return (count & RWSEM_FLAG_READER_SPIN) && rwsem_reader_spin_ns &&
+	       !rt_task(current);
+}
+
+/*
+ * Spin for a bounded time waiting for a running writer to release the
+ * lock. Unlike writers, readers don't queue on the osq: they only poll
+ * the count, and give up as soon as the writer is scheduled out, a
+ * waiter has requested a handoff or the time limit is reached.
+ */
+static bool rwsem_reader_spin(struct rw_semaphore *sem)
+{
+	struct task_struct *owner;
+	unsigned long flags;
+	bool taken = false;
+	int loop = 0;
+	u64 deadline;
+
+	preempt_disable();
+	rcu_read_lock();
+	deadline = sched_clock() + rwsem_reader_spin_ns;
+
+	for (;;) {
+		if (rwsem_try_read_lock_unqueued(sem)) {
+			taken = true;
+			break;
+		}
+
+		if (atomic_long_read(&sem->count) & RWSEM_FLAG_HANDOFF)
+			break;
+
+		/*
+		 * A NULL owner with the writer bit set means the writer is
+		 * about to set or has just cleared the owner, keep spinning.
+		 */
+		owner = rwsem_owner_flags(sem, &flags);
+		if (owner && !(flags & RWSEM_READER_OWNED) &&
+		    !owner_on_cpu(owner))
+			break;
+
+		if (need_resched())
+			break;
+
+		if (!(++loop & 0xf) && sched_clock() > deadline)
+			break;
+
+		cpu_relax();
+	}
+
+	rcu_read_unlock();
+	preempt_enable();
+	lockevent_cond_inc(rwsem_rspin_fail, !taken);
+	return taken;
+}
+
 /*
  * Clear the owner's RWSEM_NONSPINNABLE bit if it is set. This should
  * only be called when the reader count reaches 0.
@@ -931,6 +1073,16 @@ static inline bool rwsem_optimistic_spin(struct rw_semaphore *sem)
 	return false;
 }
 
+static inline bool rwsem_can_reader_spin(long count)
+{
+	return false;
+}
+
+static inline bool rwsem_reader_spin(struct rw_semaphore *sem)
+{
+	return false;
+}
+
 static inline void clear_nonspinnable(struct rw_semaphore *sem) { }
 
 static inline enum owner_state
@@ -940,6 +1092,22 @@ rwsem_spin_on_owner(struct rw_semaphore *sem)
 }
 #endif
 
+/*
+ * Before going to sleep, ask the scheduler to run a preempted writer of
+ * lower priority next, see sched_lock_owner_boost().
+ */
+static void rwsem_boost_owner(struct rw_semaphore *sem)
+{
+	struct task_struct *owner;
+	unsigned long flags;
+
+	rcu_read_lock();
+	owner = rwsem_owner_flags(sem, &flags);
+	if (owner && !(flags & RWSEM_READER_OWNED) && owner != current)
+		sched_lock_owner_boost(owner);
+	rcu_read_unlock();
+}
+
 /*
  * Wait for the read lock to be granted
  */
@@ -952,6 +1120,7 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 	DEFINE_WAKE_Q(wake_q);
 	bool wake = false;
 	bool already_on_list = false;
+	u64 wait_start;
 
 	/*
 	 * To prevent a constant stream of readers from starving a sleeping
@@ -985,6 +1154,34 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 		return sem;
 	}
 
+	/*
+	 * Spin on a running writer if the lock opted in. Our reader bias
+	 * is dropped first so that it doesn't block the writer's release
+	 * path or a write lock handoff while we spin.
+	 */
+	if ((count & RWSEM_WRITER_LOCKED) && rwsem_can_reader_spin(count)) {
+		atomic_long_add(-RWSEM_READER_BIAS, &sem->count);
+		adjustment = 0;
+		if (rwsem_reader_spin(sem)) {
+			/*
+			 * Wake up other readers in the wait queue if it is
+			 * the first reader.
+			 */
+			count = atomic_long_read(&sem->count);
+			if ((count >> RWSEM_READER_SHIFT) == 1 &&
+			    (count & RWSEM_FLAG_WAITERS)) {
+				raw_spin_lock_irq(&sem->wait_lock);
+				if (!list_empty(&sem->wait_list))
+					rwsem_mark_wake(sem, RWSEM_WAKE_READ_OWNED,
+							&wake_q);
+				raw_spin_unlock_irq(&sem->wait_lock);
+				wake_up_q(&wake_q);
+			}
+			trace_android_vh_record_rwsem_lock_starttime(current, jiffies);
+			return sem;
+		}
+	}
+
 queue:
 	waiter.task = current;
 	waiter.type = RWSEM_WAITING_FOR_READ;
@@ -997,9 +1194,10 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 		 * In case the wait queue is empty and the lock isn't owned
 		 * by a writer or has the handoff bit set, this reader can
 		 * exit the slowpath and return immediately as its
-		 * RWSEM_READER_BIAS has already been set in the count.
+		 * RWSEM_READER_BIAS has already been set in the count,
+		 * unless it was dropped for spinning.
 		 */
-		if (!(atomic_long_read(&sem->count) &
+		if (adjustment && !(atomic_long_read(&sem->count) &
 		     (RWSEM_WRITER_MASK | RWSEM_FLAG_HANDOFF))) {
 			/* Provide lock ACQUIRE */
 			smp_acquire__after_ctrl_dep();
@@ -1040,6 +1238,7 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 
 	/* wait to be given the lock */
 	trace_android_vh_rwsem_read_wait_start(sem);
+	wait_start = rwsem_wait_start();
 	for (;;) {
 		set_current_state(state);
 		if (!smp_load_acquire(&waiter.task)) {
@@ -1054,12 +1253,14 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 			/* Ordered by sem->wait_lock against rwsem_mark_wake(). */
 			break;
 		}
+		rwsem_boost_owner(sem);
 		schedule();
 		lockevent_inc(rwsem_sleep_reader);
 	}
 
 	__set_current_state(TASK_RUNNING);
 	trace_android_vh_rwsem_read_wait_finish(sem);
+	rwsem_wait_done(rwsem_rwait_100us, wait_start);
 	lockevent_inc(rwsem_rlock);
 	trace_android_vh_record_rwsem_lock_starttime(current, jiffies);
 	return sem;
@@ -1083,6 +1284,7 @@ rwsem_down_write_slowpath(struct rw_semaphore *sem, int state)
 	struct rwsem_waiter waiter;
 	DEFINE_WAKE_Q(wake_q);
 	bool already_on_list = false;
+	u64 wait_start;
 
 	/* do optimistic spinning and steal lock if possible */
 	if (rwsem_can_spin_on_owner(sem) && rwsem_optimistic_spin(sem)) {
@@ -1145,6 +1347,7 @@ rwsem_down_write_slowpath(struct rw_semaphore *sem, int state)
 	trace_android_vh_rwsem_wake(sem);
 	/* wait until we successfully acquire the lock */
 	trace_android_vh_rwsem_write_wait_start(sem);
+	wait_start = rwsem_wait_start();
 	set_current_state(state);
 	for (;;) {
 		if (rwsem_try_write_lock(sem, &waiter)) {
@@ -1176,6 +1379,7 @@ rwsem_down_write_slowpath(struct rw_semaphore *sem, int state)
 				goto trylock_again;
 		}
 
+		rwsem_boost_owner(sem);
 		schedule();
 		lockevent_inc(rwsem_sleep_writer);
 		set_current_state(state);
@@ -1185,6 +1389,7 @@ rwsem_down_write_slowpath(struct rw_semaphore *sem, int state)
 	__set_current_state(TASK_RUNNING);
 	trace_android_vh_rwsem_write_wait_finish(sem);
 	raw_spin_unlock_irq(&sem->wait_lock);
+	rwsem_wait_done(rwsem_wwait_100us, wait_start);
 	lockevent_inc(rwsem_wlock);
 	trace_android_vh_record_rwsem_lock_starttime(current, jiffies);
 	return sem;
@@ -1281,9 +1486,11 @@ static inline int __down_read_trylock(struct rw_semaphore *sem)
 	DEBUG_RWSEMS_WARN_ON(sem->magic != sem, sem);
 
 	/*
-	 * Optimize for the case when the rwsem is not locked at all.
+	 * Optimize for the case when the rwsem is not locked at all, see
+	 * rwsem_write_trylock() for RWSEM_FLAG_READER_SPIN.
 	 */
-	tmp = RWSEM_UNLOCKED_VALUE;
+	tmp = RWSEM_UNLOCKED_VALUE |
+	      (atomic_long_read(&sem->count) & RWSEM_FLAG_READER_SPIN);
 	do {
 		if (atomic_long_try_cmpxchg_acquire(&sem->count, &tmp,
 					tmp + RWSEM_READER_BIAS)) {
@@ -22,6 +22,10 @@
 #include <linux/kmod.h>
 #include <trace/events/power.h>
 #include <linux/cpuset.h>
+#include <linux/mm.h>
+#include <linux/sched/stat.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 
 #include <trace/hooks/power.h>
 
@@ -30,8 +34,170 @@
  */
 unsigned int __read_mostly freeze_timeout_msecs = 20 * MSEC_PER_SEC;
 
+/*
+ * Tasks that did not freeze on the first pass over the task list.  Later
+ * passes only revisit these, and the whole list is scanned again once
+ * they are all frozen, to catch tasks forked in the meantime.  If the
+ * array is too small, every pass falls back to a full scan.
+ */
+struct freeze_pending {
+	struct task_struct	**tasks;
+	unsigned int		nr;
+	unsigned int		max;
+	bool			overflow;
+};
+
+#define FREEZE_NR_BLOCKERS	3
+
+/* The tasks that took longest to freeze, reported when pm_debug is on. */
+struct freeze_blocker {
+	char		comm[TASK_COMM_LEN];
+	pid_t		pid;
+	unsigned int	msecs;
+};
+
+static void freeze_pending_release(struct freeze_pending *fp)
+{
+	while (fp->nr)
+		put_task_struct(fp->tasks[--fp->nr]);
+	fp->overflow = false;
+}
+
+static unsigned int freeze_scan_all(struct freeze_pending *fp)
+{
+	struct task_struct *g, *p;
+	unsigned int todo = 0;
+
+	freeze_pending_release(fp);
+
+	read_lock(&tasklist_lock);
+	for_each_process_thread(g, p) {
+		if (p == current || !freeze_task(p))
+			continue;
+
+		if (freezer_should_skip(p))
+			continue;
+
+		todo++;
+		if (fp->nr < fp->max) {
+			get_task_struct(p);
+			fp->tasks[fp->nr++] = p;
+		} else {
+			fp->overflow = true;
+		}
+	}
+	read_unlock(&tasklist_lock);
+
+	return todo;
+}
+
+static void freeze_note_blocker(struct freeze_blocker *blockers,
+				struct task_struct *p, unsigned int msecs)
+{
+	int i = FREEZE_NR_BLOCKERS - 1;
+
+	if (msecs <= blockers[i].msecs)
+		return;
+
+	for (; i > 0 && msecs > blockers[i - 1].msecs; i--)
+		blockers[i] = blockers[i - 1];
+
+	get_task_comm(blockers[i].comm, p);
+	blockers[i].pid = task_pid_nr(p);
+	blockers[i].msecs = msecs;
+}
+
+static unsigned int freeze_scan_pending(struct freeze_pending *fp,
+					struct freeze_blocker *blockers,
+					ktime_t start)
+{
+	unsigned int msecs = ktime_to_ms(ktime_sub(ktime_get_boottime(), start));
+	unsigned int i, todo = 0;
+
+	for (i = 0; i < fp->nr; i++) {
+		struct task_struct *p = fp->tasks[i];
+
+		if (freeze_task(p) && !freezer_should_skip(p)) {
+			fp->tasks[todo++] = p;
+			continue;
+		}
+
+		if (frozen(p)) {
+			trace_freeze_task_latency(p, msecs);
+			freeze_note_blocker(blockers, p, msecs);
+		}
+		put_task_struct(p);
+	}
+	fp->nr = todo;
+
+	return todo;
+}
+
+#ifdef CONFIG_DEBUG_FS
+/* Outcome of the last user space and kernel thread freeze passes */
+static struct freeze_summary {
+	unsigned int		elapsed_msecs;
+	unsigned int		todo;
+	struct freeze_blocker	blockers[FREEZE_NR_BLOCKERS];
+} freeze_summary[2];
+static DEFINE_MUTEX(freeze_summary_lock);
+
+static void freeze_record_summary(bool user_only, unsigned int elapsed_msecs,
+				  unsigned int todo,
+				  const struct freeze_blocker *blockers)
+{
+	struct freeze_summary *sum = &freeze_summary[!user_only];
+
+	mutex_lock(&freeze_summary_lock);
+	sum->elapsed_msecs = elapsed_msecs;
+	sum->todo = todo;
+	memcpy(sum->blockers, blockers, sizeof(sum->blockers));
+	mutex_unlock(&freeze_summary_lock);
+}
+
+static int freeze_blockers_show(struct seq_file *s, void *unused)
+{
+	static const char * const names[] = { "user space", "kernel threads" };
+	struct freeze_summary *sum;
+	int i, j;
+
+	mutex_lock(&freeze_summary_lock);
+	for (i = 0; i < ARRAY_SIZE(freeze_summary); i++) {
+		sum = &freeze_summary[i];
+		seq_printf(s, "%s: elapsed_ms=%u unfrozen=%u\n", names[i],
+			   sum->elapsed_msecs, sum->todo);
+		for (j = 0; j < FREEZE_NR_BLOCKERS && sum->blockers[j].msecs;
+		     j++)
+			seq_printf(s, "  %s:%d %u ms\n", sum->blockers[j].comm,
+				   sum->blockers[j].pid,
+				   sum->blockers[j].msecs);
+	}
+	mutex_unlock(&freeze_summary_lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(freeze_blockers);
+
+static int __init freeze_debugfs_init(void)
+{
+	debugfs_create_file("freeze_blockers", 0444, NULL, NULL,
+			    &freeze_blockers_fops);
+	return 0;
+}
+late_initcall(freeze_debugfs_init);
+#else
+static inline void freeze_record_summary(bool user_only,
+					 unsigned int elapsed_msecs,
+					 unsigned int todo,
+					 const struct freeze_blocker *blockers)
+{
+}
+#endif /* CONFIG_DEBUG_FS */
+
 static int try_to_freeze_tasks(bool user_only)
 {
+	struct freeze_blocker blockers[FREEZE_NR_BLOCKERS] = {};
+	struct freeze_pending fp = {};
 	struct task_struct *g, *p;
 	unsigned long end_time;
 	unsigned int todo;
@@ -39,27 +205,32 @@ static int try_to_freeze_tasks(bool user_only)
 	ktime_t start, end, elapsed;
 	unsigned int elapsed_msecs;
 	bool wakeup = false;
+	bool full_scan = true;
 	int sleep_usecs = USEC_PER_MSEC;
 	bool todo_logging_on = false;
+	int i;
 
 	start = ktime_get_boottime();
 
 	end_time = jiffies + msecs_to_jiffies(freeze_timeout_msecs);
 
+	fp.max = READ_ONCE(nr_threads);
+	fp.tasks = kvmalloc_array(fp.max, sizeof(*fp.tasks), GFP_KERNEL);
+	if (!fp.tasks)
+		fp.max = 0;
+
 	if (!user_only)
 		freeze_workqueues_begin();
 
 	while (true) {
-		todo = 0;
-		read_lock(&tasklist_lock);
-		for_each_process_thread(g, p) {
-			if (p == current || !freeze_task(p))
-				continue;
-
-			if (!freezer_should_skip(p))
-				todo++;
+		if (full_scan) {
+			todo = freeze_scan_all(&fp);
+		} else {
+			todo = freeze_scan_pending(&fp, blockers, start);
+			if (!todo)
+				todo = freeze_scan_all(&fp);
 		}
-		read_unlock(&tasklist_lock);
+		full_scan = fp.overflow;
 
 		if (!user_only) {
 			wq_busy = freeze_workqueues_busy();
@@ -119,8 +290,19 @@ static int try_to_freeze_tasks(bool user_only)
 	} else {
 		pr_cont("(elapsed %d.%03d seconds) ", elapsed_msecs / 1000,
 			elapsed_msecs % 1000);
+		/* Stay on the caller's line, it finishes it with "done." */
+		for (i = 0; pm_debug_messages_on &&
+			    i < FREEZE_NR_BLOCKERS && blockers[i].msecs; i++)
+			pr_cont("[%s:%d %u ms] ", blockers[i].comm,
+				blockers[i].pid, blockers[i].msecs);
 	}
 
+	freeze_record_summary(user_only, elapsed_msecs, todo - wq_busy,
+			      blockers);
+
+	freeze_pending_release(&fp);
+	kvfree(fp.tasks);
+
 	return todo ? -EBUSY : 0;
 }
 
@@ -523,8 +523,22 @@ static int swap_writer_finish(struct swap_map_handle *handle,
 			             LZO_HEADER, PAGE_SIZE)
 #define LZO_CMP_SIZE	(LZO_CMP_PAGES * PAGE_SIZE)
 
-/* Maximum number of threads for compression/decompression. */
+/* Default and upper limit of threads for compression/decompression. */
 #define LZO_THREADS	3
+#define LZO_MAX_THREADS	32
+
+static unsigned int hibernate_compression_threads = LZO_THREADS;
+
+static int __init hibernate_compression_threads_setup(char *str)
+{
+	unsigned int n;
+
+	if (kstrtouint(str, 0, &n))
+		return 0;
+	hibernate_compression_threads = clamp_val(n, 1, LZO_MAX_THREADS);
+	return 1;
+}
+__setup("hibernate_compression_threads=", hibernate_compression_threads_setup);
 
 /* Minimum/maximum number of pages for read buffering. */
 #define LZO_MIN_RD_PAGES	1024
@@ -590,10 +604,38 @@ struct crc_data {
 	wait_queue_head_t go;                     /* start crc update */
 	wait_queue_head_t done;                   /* crc update done */
 	u32 *crc32;                               /* points to handle's crc32 */
-	size_t *unc_len[LZO_THREADS];             /* uncompressed lengths */
-	unsigned char *unc[LZO_THREADS];          /* uncompressed data */
+	size_t **unc_len;                         /* uncompressed lengths */
+	unsigned char **unc;                      /* uncompressed data */
 };
 
+static struct crc_data *alloc_crc_data(unsigned int nr_threads)
+{
+	struct crc_data *crc;
+
+	crc = kzalloc(sizeof(*crc), GFP_KERNEL);
+	if (!crc)
+		return NULL;
+
+	crc->unc = kcalloc(nr_threads, sizeof(*crc->unc), GFP_KERNEL);
+	crc->unc_len = kcalloc(nr_threads, sizeof(*crc->unc_len), GFP_KERNEL);
+	if (!crc->unc || !crc->unc_len) {
+		kfree(crc->unc);
+		kfree(crc->unc_len);
+		kfree(crc);
+		return NULL;
+	}
+	return crc;
+}
+
+static void free_crc_data(struct crc_data *crc)
+{
+	if (crc->thr)
+		kthread_stop(crc->thr);
+	kfree(crc->unc);
+	kfree(crc->unc_len);
+	kfree(crc);
+}
+
 /**
  * CRC32 update function that runs in its own thread.
  */
@@ -693,10 +735,11 @@ static int save_image_lzo(struct swap_map_handle *handle,
 
 	/*
 	 * We'll limit the number of threads for compression to limit memory
-	 * footprint.
+	 * footprint; the limit can be raised with
+	 * hibernate_compression_threads= on machines with many CPUs.
 	 */
 	nr_threads = num_online_cpus() - 1;
-	nr_threads = clamp_val(nr_threads, 1, LZO_THREADS);
+	nr_threads = clamp_val(nr_threads, 1, hibernate_compression_threads);
 
 	page = (void *)__get_free_page(GFP_NOIO | __GFP_HIGH);
 	if (!page) {
@@ -714,13 +757,12 @@ static int save_image_lzo(struct swap_map_handle *handle,
 	for (thr = 0; thr < nr_threads; thr++)
 		memset(&data[thr], 0, offsetof(struct cmp_data, go));
 
-	crc = kmalloc(sizeof(*crc), GFP_KERNEL);
+	crc = alloc_crc_data(nr_threads);
 	if (!crc) {
 		pr_err("Failed to allocate crc\n");
 		ret = -ENOMEM;
 		goto out_clean;
 	}
-	memset(crc, 0, offsetof(struct crc_data, go));
 
 	/*
 	 * Start the compression threads.
@@ -864,11 +906,8 @@ static int save_image_lzo(struct swap_map_handle *handle,
 	swsusp_show_speed(start, stop, nr_to_write, "Wrote");
 out_clean:
 	hib_finish_batch(&hb);
-	if (crc) {
-		if (crc->thr)
-			kthread_stop(crc->thr);
-		kfree(crc);
-	}
+	if (crc)
+		free_crc_data(crc);
 	if (data) {
 		for (thr = 0; thr < nr_threads; thr++)
 			if (data[thr].thr)
@@ -1186,10 +1225,11 @@ static int load_image_lzo(struct swap_map_handle *handle,
 
 	/*
 	 * We'll limit the number of threads for decompression to limit memory
-	 * footprint.
+	 * footprint; the limit can be raised with
+	 * hibernate_compression_threads= on machines with many CPUs.
 	 */
 	nr_threads = num_online_cpus() - 1;
-	nr_threads = clamp_val(nr_threads, 1, LZO_THREADS);
+	nr_threads = clamp_val(nr_threads, 1, hibernate_compression_threads);
 
 	page = vmalloc(array_size(LZO_MAX_RD_PAGES, sizeof(*page)));
 	if (!page) {
@@ -1207,13 +1247,12 @@ static int load_image_lzo(struct swap_map_handle *handle,
 	for (thr = 0; thr < nr_threads; thr++)
 		memset(&data[thr], 0, offsetof(struct dec_data, go));
 
-	crc = kmalloc(sizeof(*crc), GFP_KERNEL);
+	crc = alloc_crc_data(nr_threads);
 	if (!crc) {
 		pr_err("Failed to allocate crc\n");
 		ret = -ENOMEM;
 		goto out_clean;
 	}
-	memset(crc, 0, offsetof(struct crc_data, go));
 
 	clean_pages_on_decompress = true;
 
@@ -1461,11 +1500,8 @@ static int load_image_lzo(struct swap_map_handle *handle,
 	hib_finish_batch(&hb);
 	for (i = 0; i < ring_size; i++)
 		free_page((unsigned long)page[i]);
-	if (crc) {
-		if (crc->thr)
-			kthread_stop(crc->thr);
-		kfree(crc);
-	}
+	if (crc)
+		free_crc_data(crc);
 	if (data) {
 		for (thr = 0; thr < nr_threads; thr++)
 			if (data[thr].thr)
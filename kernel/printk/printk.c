@@ -42,6 +42,7 @@
 #include <linux/rculist.h>
 #include <linux/poll.h>
 #include <linux/irq_work.h>
+#include <linux/kthread.h>
 #include <linux/ctype.h>
 #include <linux/uio.h>
 #include <linux/sched/clock.h>
@@ -1901,6 +1902,70 @@ static int console_trylock_spinning(void)
 	return 1;
 }
 
+/*
+ * Output statistics of the registered consoles, protected by console_sem.
+ * They are kept here rather than in struct console, whose layout drivers
+ * are built against. A slot is claimed on a console's first write and
+ * released when it is unregistered; consoles beyond the first
+ * CONSOLE_STATS_MAX simply go uncounted.
+ */
+#define CONSOLE_STATS_MAX	8
+
+static struct console_write_stats {
+	struct console	*con;
+	unsigned long	nr_written;
+	u64		write_ns;
+	u64		write_ns_max;
+} console_write_stats[CONSOLE_STATS_MAX];
+
+static struct console_write_stats *console_stats_find(struct console *con,
+						      bool claim)
+{
+	struct console_write_stats *stats, *free = NULL;
+
+	for (stats = console_write_stats;
+	     stats < console_write_stats + CONSOLE_STATS_MAX; stats++) {
+		if (stats->con == con)
+			return stats;
+		if (!stats->con && !free)
+			free = stats;
+	}
+
+	if (!claim || !free)
+		return NULL;
+
+	memset(free, 0, sizeof(*free));
+	free->con = con;
+	return free;
+}
+
+static void console_stats_release(struct console *con)
+{
+	struct console_write_stats *stats = console_stats_find(con, false);
+
+	if (stats)
+		stats->con = NULL;
+}
+
+static void call_console_write(struct console *con, const char *text,
+			       size_t len)
+{
+	struct console_write_stats *stats = console_stats_find(con, true);
+	u64 start = local_clock();
+	u64 delta;
+
+	con->write(con, text, len);
+
+	if (!stats)
+		return;
+
+	delta = local_clock() - start;
+	stats->nr_written++;
+	stats->write_ns += delta;
+	if (delta > stats->write_ns_max)
+		stats->write_ns_max = delta;
+}
+
 /*
  * Call the console drivers, asking them to write out
  * log_buf[start] to log_buf[end - 1].
@@ -1936,11 +2001,12 @@ static void call_console_drivers(const char *ext_text, size_t ext_len,
 		    !(con->flags & CON_ANYTIME))
 			continue;
 		if (con->flags & CON_EXTENDED)
-			con->write(con, ext_text, ext_len);
+			call_console_write(con, ext_text, ext_len);
 		else {
 			if (dropped_len)
-				con->write(con, dropped_text, dropped_len);
-			con->write(con, text, len);
+				call_console_write(con, dropped_text,
+						   dropped_len);
+			call_console_write(con, text, len);
 		}
 	}
 }
@@ -2228,6 +2294,40 @@ int vprintk_store(int facility, int level,
 	return ret;
 }
 
+/*
+ * Once the console printing kthread is up, printk() callers only store
+ * their message and queue a wakeup for it, rather than writing out the
+ * consoles themselves. Outside of normal runtime, i.e. during boot,
+ * shutdown, oops and panic, printing stays synchronous.
+ */
+static struct task_struct *printk_kthread;
+static bool printk_console_kthread = true;
+module_param_named(console_kthread, printk_console_kthread, bool, 0644);
+
+static void defer_console_output_kthread(void);
+
+static bool printk_kthread_printing(void)
+{
+	return printk_console_kthread && READ_ONCE(printk_kthread) &&
+	       system_state == SYSTEM_RUNNING && !oops_in_progress &&
+	       atomic_read(&panic_cpu) == PANIC_CPU_INVALID;
+}
+
+/*
+ * Warnings and anything more severe (WARN(), lockup and hung task reports,
+ * sysrq at the default level) are still printed by the caller, so that
+ * they reach the console even if the machine hangs or resets right after.
+ */
+static bool printk_kthread_may_defer(int level, const char *fmt)
+{
+	if (level == LOGLEVEL_DEFAULT)
+		printk_parse_prefix(fmt, &level, NULL);
+	if (level == LOGLEVEL_DEFAULT)
+		level = default_message_loglevel;
+
+	return level > LOGLEVEL_WARNING && printk_kthread_printing();
+}
+
 asmlinkage int vprintk_emit(int facility, int level,
 			    const struct dev_printk_info *dev_info,
 			    const char *fmt, va_list args)
@@ -2250,7 +2350,9 @@ asmlinkage int vprintk_emit(int facility, int level,
 	printed_len = vprintk_store(facility, level, dev_info, fmt, args);
 
 	/* If called from the scheduler, we can not call up(). */
-	if (!in_sched) {
+	if (!in_sched && printk_kthread_may_defer(level, fmt)) {
+		defer_console_output_kthread();
+	} else if (!in_sched) {
 		/*
 		 * Disable preemption to avoid being preempted while holding
 		 * console_sem which would prevent anyone from printing to
@@ -2321,6 +2423,7 @@ static void console_lock_spinning_enable(void) { }
 static int console_lock_spinning_disable_and_check(void) { return 0; }
 static void call_console_drivers(const char *ext_text, size_t ext_len,
 				 const char *text, size_t len) {}
+static void console_stats_release(struct console *con) { }
 static bool suppress_message_printing(int level) { return false; }
 
 #endif /* CONFIG_PRINTK */
@@ -3127,6 +3230,8 @@ int unregister_console(struct console *console)
 	if (console->flags & CON_EXTENDED)
 		nr_ext_console_drivers--;
 
+	console_stats_release(console);
+
 	/*
 	 * If this isn't the last console and it has CON_CONSDEV set, we
 	 * need to set it on the next preferred console.
@@ -3236,13 +3341,104 @@ late_initcall(printk_late_init);
  */
 #define PRINTK_PENDING_WAKEUP	0x01
 #define PRINTK_PENDING_OUTPUT	0x02
+#define PRINTK_PENDING_KTHREAD	0x04
 
 static DEFINE_PER_CPU(int, printk_pending);
 
+static DECLARE_WAIT_QUEUE_HEAD(printk_kthread_wait);
+static atomic_t printk_kthread_pending = ATOMIC_INIT(0);
+
+static int printk_kthread_func(void *unused)
+{
+	for (;;) {
+		wait_event_interruptible(printk_kthread_wait,
+				atomic_read(&printk_kthread_pending));
+		/*
+		 * Clear the request before taking console_sem, anything
+		 * stored after console_unlock() has finished checking for
+		 * new records comes with a new request.
+		 */
+		atomic_set(&printk_kthread_pending, 0);
+		console_lock();
+		console_unlock();
+	}
+
+	return 0;
+}
+
+static void wake_up_printk_kthread(void)
+{
+	atomic_set(&printk_kthread_pending, 1);
+	wake_up_interruptible(&printk_kthread_wait);
+}
+
+static int __init printk_kthread_init(void)
+{
+	struct task_struct *tsk;
+
+	tsk = kthread_run(printk_kthread_func, NULL, "pr/console");
+	if (IS_ERR(tsk)) {
+		pr_err("failed to start console printing thread\n");
+		return PTR_ERR(tsk);
+	}
+	WRITE_ONCE(printk_kthread, tsk);
+	wake_up_printk_kthread();
+
+	return 0;
+}
+late_initcall(printk_kthread_init);
+
+static int param_get_console_stats(char *buffer, const struct kernel_param *kp)
+{
+	struct console_write_stats *stats;
+	struct console *con;
+	int len;
+
+	/*
+	 * console_sem only keeps the console list stable here. Release it
+	 * without console_unlock(), so that reading the stats does not write
+	 * out the backlog in the reader's context, and leave any records
+	 * stored meanwhile to the usual printer.
+	 */
+	console_lock();
+	len = scnprintf(buffer, PAGE_SIZE, "backlog=%llu\n",
+			prb_next_seq(prb) - console_seq);
+	for_each_console(con) {
+		stats = console_stats_find(con, false);
+		if (!stats)
+			continue;
+		len += scnprintf(buffer + len, PAGE_SIZE - len,
+				 "%s%d: written=%lu write_us=%llu max_write_us=%llu\n",
+				 con->name, con->index, stats->nr_written,
+				 div_u64(stats->write_ns, NSEC_PER_USEC),
+				 div_u64(stats->write_ns_max, NSEC_PER_USEC));
+	}
+	console_locked = 0;
+	console_may_schedule = 0;
+	up_console_sem();
+
+	if (prb_next_seq(prb) != READ_ONCE(console_seq))
+		defer_console_output_kthread();
+
+	return len;
+}
+
+static const struct kernel_param_ops console_stats_ops = {
+	.get = param_get_console_stats,
+};
+module_param_cb(console_stats, &console_stats_ops, NULL, 0444);
+
 static void wake_up_klogd_work_func(struct irq_work *irq_work)
 {
 	int pending = __this_cpu_xchg(printk_pending, 0);
 
+	if (pending & PRINTK_PENDING_KTHREAD) {
+		if (printk_kthread_printing())
+			wake_up_printk_kthread();
+		else
+			pending |= PRINTK_PENDING_OUTPUT;
+	}
+
 	if (pending & PRINTK_PENDING_OUTPUT) {
 		/* If trylock fails, someone else is doing the printing */
 		if (console_trylock())
@@ -3280,6 +3476,18 @@ void defer_console_output(void)
 	preempt_enable();
 }
 
+/* Hand the pending output to the printing kthread, if it is in use */
+static void defer_console_output_kthread(void)
+{
+	if (!printk_percpu_data_ready())
+		return;
+
+	preempt_disable();
+	__this_cpu_or(printk_pending, PRINTK_PENDING_KTHREAD);
+	irq_work_queue(this_cpu_ptr(&wake_up_klogd_work));
+	preempt_enable();
+}
+
 void printk_trigger_flush(void)
 {
 	defer_console_output();
@@ -478,6 +478,35 @@ module_param(rcu_divisor, int, 0644);
 static long rcu_resched_ns = 3 * NSEC_PER_MSEC;
 module_param(rcu_resched_ns, long, 0644);
 
+/*
+ * Per-CPU callback invocation statistics, one line per CPU listing the
+ * callbacks and batches invoked, and the total and longest time spent
+ * in rcu_do_batch() in microseconds.  Display only!
+ */
+static int param_get_cb_stats(char *buffer, const struct kernel_param *kp)
+{
+	int cpu;
+	int len = 0;
+
+	for_each_possible_cpu(cpu) {
+		struct rcu_data *rdp = per_cpu_ptr(&rcu_data, cpu);
+
+		len += scnprintf(buffer + len, PAGE_SIZE - len,
+				 "%d: cbs=%lu batches=%lu total_us=%llu max_us=%llu offloaded=%d\n",
+				 cpu, READ_ONCE(rdp->n_cbs_invoked),
+				 READ_ONCE(rdp->n_cb_batches),
+				 div_u64(READ_ONCE(rdp->cb_batch_ns), NSEC_PER_USEC),
+				 div_u64(READ_ONCE(rdp->cb_batch_ns_max), NSEC_PER_USEC),
+				 rcu_rdp_is_offloaded(rdp));
+	}
+	return len;
+}
+
+static const struct kernel_param_ops cb_stats_ops = {
+	.get = param_get_cb_stats,
+};
+module_param_cb(cb_stats, &cb_stats_ops, NULL, 0444);
+
 /*
  * How long the grace period must be before we start recruiting
  * quiescent-state help from rcu_note_context_switch().
@@ -2452,6 +2481,7 @@ static void rcu_do_batch(struct rcu_data *rdp)
 	struct rcu_cblist rcl = RCU_CBLIST_INITIALIZER(rcl);
 	long bl, count = 0;
 	long pending, tlimit = 0;
+	u64 start, duration;
 
 	/* If no callbacks are ready, just return. */
 	if (!rcu_segcblist_ready_cbs(&rdp->cblist)) {
@@ -2493,6 +2523,7 @@ static void rcu_do_batch(struct rcu_data *rdp)
 
 	/* Invoke callbacks. */
 	tick_dep_set_task(current, TICK_DEP_BIT_RCU);
+	start = local_clock();
 	rhp = rcu_cblist_dequeue(&rcl);
 
 	for (; rhp; rhp = rcu_cblist_dequeue(&rcl)) {
@@ -2538,9 +2569,15 @@ static void rcu_do_batch(struct rcu_data *rdp)
 		}
 	}
 
+	duration = local_clock() - start;
+
 	local_irq_save(flags);
 	rcu_nocb_lock(rdp);
 	rdp->n_cbs_invoked += count;
+	rdp->n_cb_batches++;
+	rdp->cb_batch_ns += duration;
+	if (duration > rdp->cb_batch_ns_max)
+		rdp->cb_batch_ns_max = duration;
 	trace_rcu_batch_end(rcu_state.name, count, !!rcl.head, need_resched(),
 			    is_idle_task(current), rcu_is_callbacks_kthread());
 
@@ -181,6 +181,9 @@ struct rcu_data {
 	long		qlen_last_fqs_check;
 					/* qlen at last check for QS forcing */
 	unsigned long	n_cbs_invoked;	/* # callbacks invoked since boot. */
+	unsigned long	n_cb_batches;	/* # of rcu_do_batch() invocations. */
+	u64		cb_batch_ns;	/* Total time spent invoking CBs. */
+	u64		cb_batch_ns_max; /* Longest single rcu_do_batch(). */
 	unsigned long	n_force_qs_snap;
 					/* did other CPU force QS recently? */
 	long		blimit;		/* Upper limit on a processed batch */
@@ -1111,6 +1111,66 @@ int rcu_nocb_cpu_offload(int cpu)
 }
 EXPORT_SYMBOL_GPL(rcu_nocb_cpu_offload);
 
+/*
+ * Runtime control of callback offloading: writing a CPU list to
+ * /sys/module/rcutree/parameters/nocb_offloaded offloads the callbacks
+ * of the listed CPUs to their rcuo kthreads, which can then be confined
+ * to housekeeping CPUs, and hands the callbacks of the other CPUs back
+ * to softirq.  Only CPUs set up for offloading at boot through
+ * rcu_nocbs= can be switched.
+ */
+static int param_set_nocb_offloaded(const char *val,
+				    const struct kernel_param *kp)
+{
+	cpumask_var_t mask;
+	int cpu, err, ret = 0;
+
+	if (rcu_scheduler_active != RCU_SCHEDULER_RUNNING)
+		return -EAGAIN;
+
+	if (!alloc_cpumask_var(&mask, GFP_KERNEL))
+		return -ENOMEM;
+
+	ret = cpulist_parse(val, mask);
+	if (ret)
+		goto out;
+
+	for_each_cpu(cpu, mask) {
+		if (!per_cpu_ptr(&rcu_data, cpu)->nocb_gp_rdp) {
+			ret = -EINVAL;
+			goto out;
+		}
+	}
+
+	for_each_possible_cpu(cpu) {
+		if (!per_cpu_ptr(&rcu_data, cpu)->nocb_gp_rdp)
+			continue;
+		if (cpumask_test_cpu(cpu, mask))
+			err = rcu_nocb_cpu_offload(cpu);
+		else
+			err = rcu_nocb_cpu_deoffload(cpu);
+		if (err && !ret)
+			ret = err;
+	}
+out:
+	free_cpumask_var(mask);
+	return ret;
+}
+
+static int param_get_nocb_offloaded(char *buffer,
+				    const struct kernel_param *kp)
+{
+	if (!cpumask_available(rcu_nocb_mask))
+		return sprintf(buffer, "\n");
+	return sprintf(buffer, "%*pbl\n", cpumask_pr_args(rcu_nocb_mask));
+}
+
+static const struct kernel_param_ops nocb_offloaded_ops = {
+	.set = param_set_nocb_offloaded,
+	.get = param_get_nocb_offloaded,
+};
+module_param_cb(nocb_offloaded, &nocb_offloaded_ops, NULL, 0644);
+
 void __init rcu_init_nohz(void)
 {
 	int cpu;
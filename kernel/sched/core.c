@@ -8548,6 +8548,60 @@ int __sched yield_to(struct task_struct *p, bool preempt)
 }
 EXPORT_SYMBOL_GPL(yield_to);
 
+/**
+ * sched_lock_owner_boost - run a lock owner next on its CPU
+ * @owner: task holding a sleeping lock current is about to block on
+ *
+ * A fair task blocking on a mutex or rwsem held by a runnable but
+ * preempted fair task of lower priority would otherwise wait until the
+ * owner gets its slice back. Make the owner the next buddy on its
+ * runqueue and have that CPU reschedule, so that the task running there
+ * is preempted in favour of the owner. Unlike yield_to(), that task is
+ * not marked as having yielded, and current doesn't yield either as it
+ * is going to sleep anyway.
+ *
+ * Boosts are reported through the sched_lock_owner_boost tracepoint.
+ *
+ * It's the caller's job to ensure that the owner task struct can't go
+ * away on us.
+ *
+ * Return: true if the owner was boosted.
+ */
+bool sched_lock_owner_boost(struct task_struct *owner)
+{
+	struct task_struct *curr = current;
+	bool boosted = false;
+	struct rq_flags rf;
+	struct rq *rq;
+
+	if (!sched_feat(LOCK_OWNER_BOOST))
+		return false;
+
+	if (curr->sched_class != &fair_sched_class ||
+	    curr->prio >= owner->prio)
+		return false;
+
+	trace_android_vh_lock_owner_boost(owner, curr, &boosted);
+	if (boosted)
+		goto out;
+
+	rq = task_rq_lock(owner, &rf);
+	if (owner->sched_class == &fair_sched_class &&
+	    rq->curr->sched_class == &fair_sched_class &&
+	    task_on_rq_queued(owner) && !task_running(rq, owner)) {
+		boosted = set_next_buddy_fair(rq, owner);
+		if (boosted)
+			resched_curr(rq);
+	}
+	task_rq_unlock(rq, owner, &rf);
+
+out:
+	if (boosted)
+		trace_sched_lock_owner_boost(owner, curr);
+
+	return boosted;
+}
+
 int io_schedule_prepare(void)
 {
 	int old_iowait = current->in_iowait;
@@ -7612,6 +7612,26 @@ static bool yield_to_task_fair(struct rq *rq, struct task_struct *p)
 	return true;
 }
 
+/*
+ * Ask for @p to be picked next on @rq without yielding the task that is
+ * currently running there, see sched_lock_owner_boost(). The caller holds
+ * the rq lock and reschedules the CPU.
+ */
+bool set_next_buddy_fair(struct rq *rq, struct task_struct *p)
+{
+	struct sched_entity *se = &p->se;
+
+	lockdep_assert_rq_held(rq);
+
+	/* throttled hierarchies are not runnable */
+	if (!se->on_rq || throttled_hierarchy(cfs_rq_of(se)))
+		return false;
+
+	set_next_buddy(se);
+
+	return true;
+}
+
 #ifdef CONFIG_SMP
 /**************************************************
  * Fair scheduling class load-balancing methods.
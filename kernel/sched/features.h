@@ -93,5 +93,11 @@ SCHED_FEAT(UTIL_EST_FASTUP, true)
 
 SCHED_FEAT(LATENCY_WARN, false)
 
+/*
+ * Let a task blocking on a sleeping lock have the lock owner picked next
+ * on its CPU, when the owner is runnable and of lower priority.
+ */
+SCHED_FEAT(LOCK_OWNER_BOOST, false)
+
 SCHED_FEAT(ALT_PERIOD, true)
 SCHED_FEAT(BASE_SLICE, true)
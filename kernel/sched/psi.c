@@ -177,6 +177,8 @@ __setup("psi=", setup_psi);
 #define WINDOW_MIN_US 500000	/* Min window size is 500ms */
 #define WINDOW_MAX_US 10000000	/* Max window size is 10s */
 #define UPDATES_PER_WINDOW 10	/* 10 updates per window */
+#define LATENCY_MIN_US 10000	/* Min event latency is 10ms */
+#define TRIGGERS_PER_FILE 4	/* Max triggers on one file descriptor */
 
 /* Sampling frequency in nanoseconds */
 static u64 psi_period __read_mostly;
@@ -195,6 +197,7 @@ static void group_init(struct psi_group *group)
 {
 	int cpu;
 
+	group->enabled = true;
 	for_each_possible_cpu(cpu)
 		seqcount_init(&per_cpu_ptr(group->pcpu, cpu)->seq);
 	group->avg_last_update = sched_clock();
@@ -554,6 +557,7 @@ static u64 update_triggers(struct psi_group *group, u64 now)
 			continue;
 
 		/* Generate an event */
+		WRITE_ONCE(t->last_event_growth, growth);
 		if (cmpxchg(&t->event, 0, 1) == 0)
 			wake_up_interruptible(&t->event_wait);
 		t->last_event_time = now;
@@ -593,6 +597,23 @@ static void psi_schedule_poll_work(struct psi_group *group, unsigned long delay)
 	rcu_read_unlock();
 }
 
+/*
+ * The shortest tracking window of the group's triggers. Not cached in
+ * struct psi_group, which is embedded in struct cgroup, to keep its layout.
+ */
+static u64 psi_poll_min_window(struct psi_group *group)
+{
+	struct psi_trigger *t;
+	u64 window = ULLONG_MAX;
+
+	lockdep_assert_held(&group->trigger_lock);
+
+	list_for_each_entry(t, &group->triggers, node)
+		window = min(window, t->win.size);
+
+	return window;
+}
+
 static void psi_poll_work(struct psi_group *group)
 {
 	u32 changed_states;
@@ -614,8 +635,7 @@ static void psi_poll_work(struct psi_group *group)
 		 * minimum tracking window as long as monitor states are
 		 * changing.
 		 */
-		group->polling_until = now +
-			group->poll_min_period * UPDATES_PER_WINDOW;
+		group->polling_until = now + psi_poll_min_window(group);
 	}
 
 	if (now > group->polling_until) {
@@ -709,7 +729,15 @@ static void psi_group_change(struct psi_group *group, int cpu,
 	 */
 	write_seqcount_begin(&groupc->seq);
 
-	record_times(groupc, now);
+	/*
+	 * With accounting disabled for this group only the task counts are
+	 * kept current, so that it can be re-enabled at any time. The first
+	 * change after disabling still concludes the live state, so that the
+	 * aggregator doesn't see a negative delta once it is re-enabled.
+	 */
+	if (likely(group->enabled) ||
+	    unlikely(groupc->state_mask & (1 << PSI_NONIDLE)))
+		record_times(groupc, now);
 
 	for (t = 0, m = clear; m; m &= ~(1 << t), t++) {
 		if (!(m & (1 << t)))
@@ -730,6 +758,12 @@ static void psi_group_change(struct psi_group *group, int cpu,
 		if (set & (1 << t))
 			groupc->tasks[t]++;
 
+	if (unlikely(!group->enabled)) {
+		groupc->state_mask = 0;
+		write_seqcount_end(&groupc->seq);
+		return;
+	}
+
 	/* Calculate state mask representing active states */
 	for (s = 0; s < NR_PSI_STATES; s++) {
 		if (test_state(groupc->tasks, s))
@@ -977,6 +1011,31 @@ void psi_cgroup_free(struct cgroup *cgroup)
 	WARN_ONCE(cgroup->psi.poll_states, "psi: trigger leak\n");
 }
 
+/**
+ * psi_cgroup_restart - resume stall accounting of a cgroup
+ * @group: the cgroup's psi group, with ->enabled just set
+ *
+ * The task counts were maintained while accounting was disabled, so a
+ * state change without any task change on every CPU is enough to work out
+ * the current state mask again and restart the state clocks from now.
+ */
+void psi_cgroup_restart(struct psi_group *group)
+{
+	int cpu;
+
+	if (static_branch_likely(&psi_disabled) || !group->enabled)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		struct rq *rq = cpu_rq(cpu);
+		struct rq_flags rf;
+
+		rq_lock_irq(rq, &rf);
+		psi_group_change(group, cpu, 0, 0, cpu_clock(cpu), true);
+		rq_unlock_irq(rq, &rf);
+	}
+}
+
 /**
  * cgroup_move_task - move task to a different cgroup
  * @task: the task
@@ -1050,7 +1109,7 @@ int psi_show(struct seq_file *m, struct psi_group *group, enum psi_res res)
 	int full;
 	u64 now;
 
-	if (static_branch_likely(&psi_disabled))
+	if (static_branch_likely(&psi_disabled) || !group->enabled)
 		return -EOPNOTSUPP;
 
 	/* Update averages before reporting them */
@@ -1089,13 +1148,17 @@ struct psi_trigger *psi_trigger_create(struct psi_group *group,
 	enum psi_states state;
 	u32 threshold_us;
 	u32 window_us;
+	u32 latency_us = 0;
 
-	if (static_branch_likely(&psi_disabled))
+	if (static_branch_likely(&psi_disabled) || !group->enabled)
 		return ERR_PTR(-EOPNOTSUPP);
 
-	if (sscanf(buf, "some %u %u", &threshold_us, &window_us) == 2)
+	/* The event latency is optional and defaults to 1/10th of the window */
+	if (sscanf(buf, "some %u %u %u",
+		   &threshold_us, &window_us, &latency_us) >= 2)
 		state = PSI_IO_SOME + res * 2;
-	else if (sscanf(buf, "full %u %u", &threshold_us, &window_us) == 2)
+	else if (sscanf(buf, "full %u %u %u",
+			&threshold_us, &window_us, &latency_us) >= 2)
 		state = PSI_IO_FULL + res * 2;
 	else
 		return ERR_PTR(-EINVAL);
@@ -1111,6 +1174,12 @@ struct psi_trigger *psi_trigger_create(struct psi_group *group,
 	if (threshold_us == 0 || threshold_us > window_us)
 		return ERR_PTR(-EINVAL);
 
+	if (!latency_us)
+		latency_us = window_us / UPDATES_PER_WINDOW;
+	else if (latency_us < LATENCY_MIN_US ||
+		 latency_us > window_us / UPDATES_PER_WINDOW)
+		return ERR_PTR(-EINVAL);
+
 	t = kmalloc(sizeof(*t), GFP_KERNEL);
 	if (!t)
 		return ERR_PTR(-ENOMEM);
@@ -1118,11 +1187,14 @@ struct psi_trigger *psi_trigger_create(struct psi_group *group,
 	t->group = group;
 	t->state = state;
 	t->threshold = threshold_us * NSEC_PER_USEC;
+	t->latency = latency_us * NSEC_PER_USEC;
 	t->win.size = window_us * NSEC_PER_USEC;
 	window_reset(&t->win, 0, 0, 0);
 
 	t->event = 0;
 	t->last_event_time = 0;
+	t->last_event_growth = 0;
+	t->next = NULL;
 	init_waitqueue_head(&t->event_wait);
 
 	mutex_lock(&group->trigger_lock);
@@ -1142,8 +1214,7 @@ struct psi_trigger *psi_trigger_create(struct psi_group *group,
 	}
 
 	list_add(&t->node, &group->triggers);
-	group->poll_min_period = min(group->poll_min_period,
-		div_u64(t->win.size, UPDATES_PER_WINDOW));
+	group->poll_min_period = min(group->poll_min_period, t->latency);
 	group->nr_triggers[t->state]++;
 	group->poll_states |= (1 << t->state);
 
@@ -1152,19 +1223,11 @@ struct psi_trigger *psi_trigger_create(struct psi_group *group,
 	return t;
 }
 
-void psi_trigger_destroy(struct psi_trigger *t)
+static void psi_trigger_destroy_one(struct psi_trigger *t)
 {
-	struct psi_group *group;
+	struct psi_group *group = t->group;
 	struct task_struct *task_to_destroy = NULL;
 
-	/*
-	 * We do not check psi_disabled since it might have been disabled after
-	 * the trigger got created.
-	 */
-	if (!t)
-		return;
-
-	group = t->group;
 	/*
 	 * Wakeup waiters to stop polling. Can happen if cgroup is deleted
 	 * from under a polling process.
@@ -1183,8 +1246,7 @@ void psi_trigger_destroy(struct psi_trigger *t)
 			group->poll_states &= ~(1 << t->state);
 		/* reset min update period for the remaining triggers */
 		list_for_each_entry(tmp, &group->triggers, node)
-			period = min(period, div_u64(tmp->win.size,
-					UPDATES_PER_WINDOW));
+			period = min(period, tmp->latency);
 		group->poll_min_period = period;
 		/* Destroy poll_task when the last trigger is destroyed */
 		if (group->poll_states == 0) {
@@ -1219,6 +1281,63 @@ void psi_trigger_destroy(struct psi_trigger *t)
 	kfree(t);
 }
 
+void psi_trigger_destroy(struct psi_trigger *t)
+{
+	struct psi_trigger *next;
+
+	/*
+	 * We do not check psi_disabled since it might have been disabled after
+	 * the trigger got created.
+	 */
+	while (t) {
+		next = t->next;
+		psi_trigger_destroy_one(t);
+		t = next;
+	}
+}
+
+/*
+ * Create a trigger from @buf and add it to the triggers already set up
+ * on a file descriptor. Writers to the same file must be serialized by
+ * the caller; pollers may walk the list concurrently.
+ */
+int psi_trigger_add(void **trigger_ptr, struct psi_group *group,
+		    char *buf, size_t nbytes, enum psi_res res)
+{
+	struct psi_trigger *head = *trigger_ptr;
+	struct psi_trigger *new, *t;
+	int nr = 0;
+
+	for (t = head; t; t = t->next)
+		nr++;
+	if (nr >= TRIGGERS_PER_FILE)
+		return -EBUSY;
+
+	new = psi_trigger_create(group, buf, nbytes, res);
+	if (IS_ERR(new))
+		return PTR_ERR(new);
+
+	new->next = head;
+	smp_store_release(trigger_ptr, new);
+
+	return 0;
+}
+
+void psi_trigger_show(struct seq_file *m, struct psi_trigger *t)
+{
+	for (; t; t = t->next) {
+		bool full = (t->state - PSI_IO_SOME) & 1;
+
+		seq_printf(m, "trigger %s threshold=%llu window=%llu latency=%llu stall=%llu\n",
+			   full ? "full" : "some",
+			   div_u64(t->threshold, NSEC_PER_USEC),
+			   div_u64(t->win.size, NSEC_PER_USEC),
+			   div_u64(t->latency, NSEC_PER_USEC),
+			   div_u64(READ_ONCE(t->last_event_growth),
+				   NSEC_PER_USEC));
+	}
+}
+
 __poll_t psi_trigger_poll(void **trigger_ptr,
 				struct file *file, poll_table *wait)
 {
@@ -1232,28 +1351,41 @@ __poll_t psi_trigger_poll(void **trigger_ptr,
 	if (!t)
 		return DEFAULT_POLLMASK | EPOLLERR | EPOLLPRI;
 
-	poll_wait(file, &t->event_wait, wait);
+	for (; t; t = t->next) {
+		poll_wait(file, &t->event_wait, wait);
 
-	if (cmpxchg(&t->event, 1, 0) == 1)
-		ret |= EPOLLPRI;
+		if (cmpxchg(&t->event, 1, 0) == 1)
+			ret |= EPOLLPRI;
+	}
 
 	return ret;
 }
 
 #ifdef CONFIG_PROC_FS
+static int psi_proc_show(struct seq_file *m, enum psi_res res)
+{
+	int ret;
+
+	ret = psi_show(m, &psi_system, res);
+	if (!ret)
+		psi_trigger_show(m, smp_load_acquire(&m->private));
+
+	return ret;
+}
+
 static int psi_io_show(struct seq_file *m, void *v)
 {
-	return psi_show(m, &psi_system, PSI_IO);
+	return psi_proc_show(m, PSI_IO);
 }
 
 static int psi_memory_show(struct seq_file *m, void *v)
 {
-	return psi_show(m, &psi_system, PSI_MEM);
+	return psi_proc_show(m, PSI_MEM);
 }
 
 static int psi_cpu_show(struct seq_file *m, void *v)
 {
-	return psi_show(m, &psi_system, PSI_CPU);
+	return psi_proc_show(m, PSI_CPU);
 }
 
 static int psi_io_open(struct inode *inode, struct file *file)
@@ -1277,7 +1409,7 @@ static ssize_t psi_write(struct file *file, const char __user *user_buf,
 	char buf[32];
 	size_t buf_size;
 	struct seq_file *seq;
-	struct psi_trigger *new;
+	int ret;
 
 	if (static_branch_likely(&psi_disabled))
 		return -EOPNOTSUPP;
@@ -1296,22 +1428,10 @@ static ssize_t psi_write(struct file *file, const char __user *user_buf,
 	/* Take seq->lock to protect seq->private from concurrent writes */
 	mutex_lock(&seq->lock);
 
-	/* Allow only one trigger per file descriptor */
-	if (seq->private) {
-		mutex_unlock(&seq->lock);
-		return -EBUSY;
-	}
-
-	new = psi_trigger_create(&psi_system, buf, nbytes, res);
-	if (IS_ERR(new)) {
-		mutex_unlock(&seq->lock);
-		return PTR_ERR(new);
-	}
-
-	smp_store_release(&seq->private, new);
+	ret = psi_trigger_add(&seq->private, &psi_system, buf, nbytes, res);
 	mutex_unlock(&seq->lock);
 
-	return nbytes;
+	return ret ? ret : nbytes;
 }
 
 static ssize_t psi_io_write(struct file *file, const char __user *user_buf,
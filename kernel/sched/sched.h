@@ -2292,6 +2292,7 @@ static inline bool sched_fair_runnable(struct rq *rq)
 }
 
 extern struct task_struct *pick_next_task_fair(struct rq *rq, struct task_struct *prev, struct rq_flags *rf);
+extern bool set_next_buddy_fair(struct rq *rq, struct task_struct *p);
 extern struct task_struct *pick_next_task_idle(struct rq *rq);
 
 #define SCA_CHECK		0x01
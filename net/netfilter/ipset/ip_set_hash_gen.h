@@ -680,13 +680,19 @@ mtype_resize(struct ip_set *set, bool retried)
 	pr_debug("attempt to resize set %s from %u to %u, t %p\n",
 		 set->name, orig->htable_bits, htable_bits, orig);
 	for (r = 0; r < ahash_numof_locks(orig->htable_bits); r++) {
-		/* Expire may replace a hbucket with another one */
-		rcu_read_lock_bh();
 		for (i = ahash_bucket_start(r, orig->htable_bits);
 		     i < ahash_bucket_end(r, orig->htable_bits); i++) {
+			/* Expire may replace a hbucket with another one.
+			 * Hold off softirqs per bucket only, so that packet
+			 * processing is not stalled for a whole region of a
+			 * large set.
+			 */
+			rcu_read_lock_bh();
 			n = __ipset_dereference(hbucket(orig, i));
-			if (!n)
+			if (!n) {
+				rcu_read_unlock_bh();
 				continue;
+			}
 			for (j = 0; j < n->pos; j++) {
 				if (!test_bit(j, n->used))
 					continue;
@@ -751,8 +757,9 @@ mtype_resize(struct ip_set *set, bool retried)
 				mtype_data_reset_flags(d, &flags);
 #endif
 			}
+			rcu_read_unlock_bh();
 		}
-		rcu_read_unlock_bh();
+		cond_resched();
 	}
 
 	/* There can't be any other writer. */
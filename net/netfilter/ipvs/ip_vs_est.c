@@ -21,6 +21,7 @@
 #include <linux/interrupt.h>
 #include <linux/sysctl.h>
 #include <linux/list.h>
+#include <linux/workqueue.h>
 
 #include <net/ip_vs.h>
 
@@ -30,8 +31,10 @@
   long interval, it is easy to implement a user level daemon which
   periodically reads those statistical counters and measure rate.
 
-  Currently, the measurement is activated by slow timer handler. Hope
-  this measurement will not introduce too much load.
+  The measurement runs from delayed work on the unbound workqueue, so
+  that summing the per-cpu counters of many services and real servers
+  is done in process context on an idle CPU instead of from a softirq
+  timer on whichever CPU armed it.
 
   We measure rate during the last 8 seconds every 2 seconds:
 
@@ -93,15 +96,30 @@ static void ip_vs_read_cpu_stats(struct ip_vs_kstats *sum,
 }
 
 
-static void estimation_timer(struct timer_list *t)
+/* Estimators updated between two reschedule points */
+#define IPVS_EST_BATCH	64
+
+static void estimation_work(struct work_struct *work)
 {
 	struct ip_vs_estimator *e;
 	struct ip_vs_stats *s;
 	u64 rate;
-	struct netns_ipvs *ipvs = from_timer(ipvs, t, est_timer);
-
-	spin_lock(&ipvs->est_lock);
-	list_for_each_entry(e, &ipvs->est_list, list) {
+	struct netns_ipvs *ipvs = container_of(to_delayed_work(work),
+					       struct netns_ipvs, est_work);
+	LIST_HEAD(done);
+	int n = 0;
+
+	/*
+	 * Estimators are moved to a private list as they are updated, so
+	 * that est_lock can be dropped between batches: stopping an
+	 * estimator meanwhile just unlinks it from whichever list it is
+	 * on, and new ones are picked up from est_list.
+	 */
+	spin_lock_bh(&ipvs->est_lock);
+	while (!list_empty(&ipvs->est_list)) {
+		e = list_first_entry(&ipvs->est_list, struct ip_vs_estimator,
+				     list);
+		list_move_tail(&e->list, &done);
 		s = container_of(e, struct ip_vs_stats, est);
 
 		spin_lock(&s->lock);
@@ -129,9 +147,16 @@ static void estimation_timer(struct timer_list *t)
 		e->last_outbytes = s->kstats.outbytes;
 		e->outbps += ((s64)rate - (s64)e->outbps) >> 2;
 		spin_unlock(&s->lock);
+
+		if (!(++n % IPVS_EST_BATCH)) {
+			spin_unlock_bh(&ipvs->est_lock);
+			cond_resched();
+			spin_lock_bh(&ipvs->est_lock);
+		}
 	}
-	spin_unlock(&ipvs->est_lock);
-	mod_timer(&ipvs->est_timer, jiffies + 2*HZ);
+	list_splice(&done, &ipvs->est_list);
+	spin_unlock_bh(&ipvs->est_lock);
+	queue_delayed_work(system_unbound_wq, &ipvs->est_work, 2 * HZ);
 }
 
 void ip_vs_start_estimator(struct netns_ipvs *ipvs, struct ip_vs_stats *stats)
@@ -188,12 +213,12 @@ int __net_init ip_vs_estimator_net_init(struct netns_ipvs *ipvs)
 {
 	INIT_LIST_HEAD(&ipvs->est_list);
 	spin_lock_init(&ipvs->est_lock);
-	timer_setup(&ipvs->est_timer, estimation_timer, 0);
-	mod_timer(&ipvs->est_timer, jiffies + 2 * HZ);
+	INIT_DELAYED_WORK(&ipvs->est_work, estimation_work);
+	queue_delayed_work(system_unbound_wq, &ipvs->est_work, 2 * HZ);
 	return 0;
 }
 
 void __net_exit ip_vs_estimator_net_cleanup(struct netns_ipvs *ipvs)
 {
-	del_timer_sync(&ipvs->est_timer);
+	cancel_delayed_work_sync(&ipvs->est_work);
 }
@@ -2059,6 +2059,21 @@ static int packet_rcv_vnet(struct msghdr *msg, const struct sk_buff *skb,
 	return memcpy_to_msg(msg, (void *)&vnet_hdr, sizeof(vnet_hdr));
 }
 
+/* Take the receive queue lock on the softirq path, accounting for the
+ * cases where another CPU already holds it.  The counter is reported
+ * through PACKET_DIAG_RX_STATS so that users can tell lock contention
+ * apart from ring or buffer exhaustion when sizing fanout groups.
+ */
+static void packet_rcv_lock(struct packet_sock *po)
+{
+	spinlock_t *lock = &po->sk.sk_receive_queue.lock;
+
+	if (unlikely(!spin_trylock(lock))) {
+		atomic_long_inc(&po->rx_contended);
+		spin_lock(lock);
+	}
+}
+
 /*
  * This function makes lazy skb cloning in hope that most of packets
  * are discarded by BPF.
@@ -2117,8 +2132,10 @@ static int packet_rcv(struct sk_buff *skb, struct net_device *dev,
 	if (snaplen > res)
 		snaplen = res;
 
-	if (atomic_read(&sk->sk_rmem_alloc) >= sk->sk_rcvbuf)
+	if (atomic_read(&sk->sk_rmem_alloc) >= sk->sk_rcvbuf) {
+		atomic_long_inc(&po->rx_rcvbuf_full);
 		goto drop_n_acct;
+	}
 
 	if (skb_shared(skb)) {
 		struct sk_buff *nskb = skb_clone(skb, GFP_ATOMIC);
@@ -2160,7 +2177,7 @@ static int packet_rcv(struct sk_buff *skb, struct net_device *dev,
 	/* drop conntrack reference */
 	nf_reset_ct(skb);
 
-	spin_lock(&sk->sk_receive_queue.lock);
+	packet_rcv_lock(po);
 	po->stats.stats1.tp_packets++;
 	sock_skb_set_dropcount(sk, skb);
 	__skb_queue_tail(&sk->sk_receive_queue, skb);
@@ -2240,6 +2257,7 @@ static int tpacket_rcv(struct sk_buff *skb, struct net_device *dev,
 	/* If we are flooded, just give up */
 	if (__packet_rcv_has_room(po, skb) == ROOM_NONE) {
 		atomic_inc(&po->tp_drops);
+		atomic_long_inc(&po->rx_ring_full);
 		goto drop_n_restore;
 	}
 
@@ -2307,16 +2325,16 @@ static int tpacket_rcv(struct sk_buff *skb, struct net_device *dev,
 			do_vnet = false;
 		}
 	}
-	spin_lock(&sk->sk_receive_queue.lock);
+	packet_rcv_lock(po);
 	h.raw = packet_current_rx_frame(po, skb,
 					TP_STATUS_KERNEL, (macoff+snaplen));
 	if (!h.raw)
-		goto drop_n_account;
+		goto ring_is_full;
 
 	if (po->tp_version <= TPACKET_V2) {
 		slot_id = po->rx_ring.head;
 		if (test_bit(slot_id, po->rx_ring.rx_owner_map))
-			goto drop_n_account;
+			goto ring_is_full;
 		__set_bit(slot_id, po->rx_ring.rx_owner_map);
 	}
 
@@ -2454,6 +2472,8 @@ static int tpacket_rcv(struct sk_buff *skb, struct net_device *dev,
 		kfree_skb(skb);
 	return 0;
 
+ring_is_full:
+	atomic_long_inc(&po->rx_ring_full);
 drop_n_account:
 	spin_unlock(&sk->sk_receive_queue.lock);
 	atomic_inc(&po->tp_drops);
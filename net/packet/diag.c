@@ -110,6 +110,17 @@ static int pdiag_put_rings_cfg(struct packet_sock *po, struct sk_buff *skb)
 	return ret;
 }
 
+static int pdiag_put_rx_stats(struct packet_sock *po, struct sk_buff *nlskb)
+{
+	struct packet_diag_rx_stats pdrs;
+
+	pdrs.pdrs_ring_full = atomic_long_read(&po->rx_ring_full);
+	pdrs.pdrs_rcvbuf_full = atomic_long_read(&po->rx_rcvbuf_full);
+	pdrs.pdrs_contended = atomic_long_read(&po->rx_contended);
+
+	return nla_put(nlskb, PACKET_DIAG_RX_STATS, sizeof(pdrs), &pdrs);
+}
+
 static int pdiag_put_fanout(struct packet_sock *po, struct sk_buff *nlskb)
 {
 	int ret = 0;
@@ -177,6 +188,10 @@ static int sk_diag_fill(struct sock *sk, struct sk_buff *skb,
 				     PACKET_DIAG_FILTER))
 		goto out_nlmsg_trim;
 
+	if ((req->pdiag_show & PACKET_SHOW_RX_STATS) &&
+	    pdiag_put_rx_stats(po, skb))
+		goto out_nlmsg_trim;
+
 	nlmsg_end(skb, nlh);
 	return 0;
 
@@ -137,6 +137,9 @@ struct packet_sock {
 	int			(*xmit)(struct sk_buff *skb);
 	struct packet_type	prot_hook ____cacheline_aligned_in_smp;
 	atomic_t		tp_drops ____cacheline_aligned_in_smp;
+	atomic_long_t		rx_ring_full;
+	atomic_long_t		rx_rcvbuf_full;
+	atomic_long_t		rx_contended;
 };
 
 static inline struct packet_sock *pkt_sk(struct sock *sk)
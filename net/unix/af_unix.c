@@ -1752,6 +1752,32 @@ static void scm_stat_del(struct sock *sk, struct sk_buff *skb)
  *	Send AF_UNIX data.
  */
 
+/* Connected datagram pairs may coalesce receiver wakeups.  With
+ * net.unix.dgram_wake_batch set, the receiver is signalled when its queue
+ * goes from empty to non-empty and then once every dgram_wake_batch
+ * messages, so a reader must drain its queue on each wakeup.  Messages
+ * carrying file descriptors or credentials always wake the receiver.
+ *
+ * Called with unix_state_lock(other) held.
+ */
+static bool unix_dgram_wake_needed(const struct socket *sock,
+				   struct sock *other, struct sk_buff *skb)
+{
+	unsigned int batch;
+	u32 qlen;
+
+	batch = READ_ONCE(sock_net(other)->unx.sysctl_dgram_wake_batch);
+	if (!batch)
+		return true;
+
+	if (unix_peer(other) != sock->sk || UNIXCB(skb).fp ||
+	    unix_passcred_enabled(sock, other))
+		return true;
+
+	qlen = skb_queue_len(&other->sk_receive_queue);
+	return qlen == 1 || !(qlen % batch);
+}
+
 static int unix_dgram_sendmsg(struct socket *sock, struct msghdr *msg,
 			      size_t len)
 {
@@ -1768,6 +1794,7 @@ static int unix_dgram_sendmsg(struct socket *sock, struct msghdr *msg,
 	struct scm_cookie scm;
 	int data_len = 0;
 	int sk_locked;
+	bool wake;
 
 	wait_for_unix_gc();
 	err = scm_send(sock, msg, &scm, false);
@@ -1937,8 +1964,10 @@ static int unix_dgram_sendmsg(struct socket *sock, struct msghdr *msg,
 	maybe_add_creds(skb, sock, other);
 	scm_stat_add(other, skb);
 	skb_queue_tail(&other->sk_receive_queue, skb);
+	wake = unix_dgram_wake_needed(sock, other, skb);
 	unix_state_unlock(other);
-	other->sk_data_ready(other);
+	if (wake)
+		other->sk_data_ready(other);
 	sock_put(other);
 	scm_destroy(&scm);
 	return len;
@@ -3330,6 +3359,7 @@ static int __net_init unix_net_init(struct net *net)
 	int error = -ENOMEM;
 
 	net->unx.sysctl_max_dgram_qlen = 10;
+	net->unx.sysctl_dgram_wake_batch = 0;
 	if (unix_sysctl_register(net))
 		goto out;
 